@@ -0,0 +1,30 @@
+# Usage: cmake -DCOMPILER=<c++> -DROOT=<repo root> -P check_trivial_abi.cmake
+#
+# Compiles trivial_abi_codegen.cpp for x86-64 and checks that the smart pointers are passed and
+# returned in registers, i.e. that the pass-through functions never dereference %rdi/%rsi.
+
+execute_process(
+    COMMAND ${COMPILER} -std=c++20 -O2 -S -fno-asynchronous-unwind-tables
+        -DSMART_PTRS_ENABLE_TRIVIAL_ABI -I${ROOT} ${ROOT}/common/trivial_abi_codegen.cpp -o -
+    OUTPUT_VARIABLE assembly
+    ERROR_VARIABLE errors
+    RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "Compilation failed:\n${errors}")
+endif()
+
+foreach(function PassUnique PassIntrusive)
+    string(REGEX MATCH "\n_Z[0-9]+${function}[^\n]*:\n" label "${assembly}")
+    if(NOT label)
+        message(FATAL_ERROR "${function} not found in the assembly")
+    endif()
+    # The body runs from the label to the first return.
+    string(FIND "${assembly}" "${label}" begin)
+    string(SUBSTRING "${assembly}" ${begin} -1 body)
+    string(FIND "${body}" "\tret" end)
+    string(SUBSTRING "${body}" 0 ${end} body)
+    if(body MATCHES "\\(%r[ds]i\\)")
+        message(FATAL_ERROR "${function} is passed through memory:${body}")
+    endif()
+    message(STATUS "${function} is passed in registers")
+endforeach()
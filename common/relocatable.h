@@ -0,0 +1,200 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// A type is trivially relocatable if moving an object to a new address and then destroying the
+// source is equivalent to copying its bytes and forgetting the source. Every smart pointer here
+// is just a handle around a raw pointer, so they opt in through a member alias:
+//
+//     using TriviallyRelocatable = std::true_type;
+template <typename T, typename = void>
+struct IsTriviallyRelocatable : std::is_trivially_copyable<T> {};
+
+template <typename T>
+struct IsTriviallyRelocatable<T, std::void_t<typename T::TriviallyRelocatable>>
+    : std::bool_constant<T::TriviallyRelocatable::value> {};
+
+template <typename T>
+inline constexpr bool kIsTriviallyRelocatable = IsTriviallyRelocatable<T>::value;
+
+// Minimal growable array that relocates trivially relocatable elements with `realloc`/`memcpy`
+// instead of a move-construct + destroy loop. For `SharedPtr` and friends this means growing the
+// buffer never touches a reference counter.
+template <typename T>
+class RelocatingVector {
+private:
+    static constexpr bool kUseRealloc =
+        kIsTriviallyRelocatable<T> && alignof(T) <= alignof(std::max_align_t);
+
+    T* data_ = nullptr;
+    size_t size_ = 0;
+    size_t capacity_ = 0;
+
+public:
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Constructors
+
+    RelocatingVector() = default;
+
+    RelocatingVector(const RelocatingVector&) = delete;
+
+    RelocatingVector(RelocatingVector&& other) noexcept
+        : data_(std::exchange(other.data_, nullptr)),
+          size_(std::exchange(other.size_, 0)),
+          capacity_(std::exchange(other.capacity_, 0)) {
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // `operator=`-s
+
+    RelocatingVector& operator=(const RelocatingVector&) = delete;
+
+    RelocatingVector& operator=(RelocatingVector&& other) noexcept {
+        if (this == &other) {
+            return *this;
+        }
+        Clear();
+        Deallocate(data_);
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+        capacity_ = std::exchange(other.capacity_, 0);
+        return *this;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Destructor
+
+    ~RelocatingVector() {
+        Clear();
+        Deallocate(data_);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Modifiers
+
+    void Reserve(size_t capacity) {
+        if (capacity <= capacity_) {
+            return;
+        }
+        if constexpr (kUseRealloc) {
+            void* data = std::realloc(static_cast<void*>(data_), capacity * sizeof(T));
+            if (data == nullptr) {
+                throw std::bad_alloc();
+            }
+            data_ = static_cast<T*>(data);
+        } else {
+            T* data = Allocate(capacity);
+            if constexpr (kIsTriviallyRelocatable<T>) {
+                if (size_ != 0) {
+                    std::memcpy(static_cast<void*>(data), static_cast<void*>(data_),
+                                size_ * sizeof(T));
+                }
+            } else {
+                for (size_t i = 0; i < size_; ++i) {
+                    new (data + i) T(std::move_if_noexcept(data_[i]));
+                    data_[i].~T();
+                }
+            }
+            Deallocate(data_);
+            data_ = data;
+        }
+        capacity_ = capacity;
+    }
+
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        if (size_ == capacity_) {
+            // `args` may refer to an element of this very vector, so build the value first.
+            T value(std::forward<Args>(args)...);
+            Reserve(capacity_ == 0 ? 1 : capacity_ * 2);
+            return *new (data_ + size_++) T(std::move(value));
+        }
+        return *new (data_ + size_++) T(std::forward<Args>(args)...);
+    }
+
+    void PushBack(const T& value) {
+        EmplaceBack(value);
+    }
+
+    void PushBack(T&& value) {
+        EmplaceBack(std::move(value));
+    }
+
+    void PopBack() {
+        data_[--size_].~T();
+    }
+
+    void Clear() {
+        while (size_ != 0) {
+            PopBack();
+        }
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Observers
+
+    size_t Size() const {
+        return size_;
+    }
+
+    size_t Capacity() const {
+        return capacity_;
+    }
+
+    bool Empty() const {
+        return size_ == 0;
+    }
+
+    T* Data() {
+        return data_;
+    }
+
+    const T* Data() const {
+        return data_;
+    }
+
+    T& operator[](size_t i) {
+        return data_[i];
+    }
+
+    const T& operator[](size_t i) const {
+        return data_[i];
+    }
+
+    T* begin() {
+        return data_;
+    }
+
+    T* end() {
+        return data_ + size_;
+    }
+
+    const T* begin() const {
+        return data_;
+    }
+
+    const T* end() const {
+        return data_ + size_;
+    }
+
+private:
+    static T* Allocate(size_t capacity) {
+        return static_cast<T*>(::operator new(capacity * sizeof(T), std::align_val_t(alignof(T))));
+    }
+
+    static void Deallocate(T* data) {
+        if (data == nullptr) {
+            return;
+        }
+        if constexpr (kUseRealloc) {
+            std::free(static_cast<void*>(data));
+        } else {
+            ::operator delete(static_cast<void*>(data), std::align_val_t(alignof(T)));
+        }
+    }
+};
@@ -0,0 +1,17 @@
+#pragma once
+
+// Opt-in: with `SMART_PTRS_ENABLE_TRIVIAL_ABI` defined and a compiler that knows
+// `[[clang::trivial_abi]]`, `UniquePtr` (with a trivial deleter) and `IntrusivePtr` are passed and
+// returned in registers like a raw pointer instead of through a stack slot.
+//
+// This changes when a by-value argument is destroyed: the callee destroys it, before the caller's
+// other temporaries. Nothing here relies on that order, but user code might, hence the opt-in.
+#if defined(SMART_PTRS_ENABLE_TRIVIAL_ABI) && defined(__has_cpp_attribute)
+#if __has_cpp_attribute(clang::trivial_abi)
+#define SMART_PTRS_TRIVIAL_ABI [[clang::trivial_abi]]
+#endif
+#endif
+
+#ifndef SMART_PTRS_TRIVIAL_ABI
+#define SMART_PTRS_TRIVIAL_ABI
+#endif
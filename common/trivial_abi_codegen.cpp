@@ -0,0 +1,18 @@
+// Compiled to assembly by `check_trivial_abi.cmake`, never linked.
+//
+// Each function hands its by-value argument straight back. With `[[clang::trivial_abi]]` the
+// pointer travels in a register both ways, so none of them may touch memory through the argument
+// or return-slot registers.
+
+#include <intrusive/intrusive.h>
+#include <unique/unique.h>
+
+struct Node : SimpleRefCounted<Node> {};
+
+UniquePtr<int> PassUnique(UniquePtr<int> ptr) {
+    return ptr;
+}
+
+IntrusivePtr<Node> PassIntrusive(IntrusivePtr<Node> ptr) {
+    return ptr;
+}
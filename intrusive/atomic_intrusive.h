@@ -0,0 +1,139 @@
+#pragma once
+
+#include "intrusive.h"
+
+#include <atomic>
+#include <cstddef>  // for std::nullptr_t
+#include <cstdint>
+#include <thread>
+#include <utility>  // for std::move
+
+// A slot holding an `IntrusivePtr<T>` that threads may read and replace concurrently.
+//
+// The pointer shares its word with a spin bit (the lowest bit; objects are at least 2-aligned).
+// `Load` sets the bit only for the span of one `IncRef`, so the object cannot lose its last
+// reference between reading the pointer and incrementing the count. `Store`, `Exchange` and
+// `CompareExchange` are single CAS-es that wait while the bit is set; they never take it
+// themselves. Publishing is a release and `Load` an acquire, so whatever was written to an object
+// before it was stored is visible to every thread that loads it.
+//
+// `T` needs a thread-safe counter, e.g. `AtomicRefCounted`.
+template <typename T>
+class AtomicIntrusivePtr {
+private:
+    static constexpr uintptr_t kLocked = 1;
+
+    mutable std::atomic<uintptr_t> word_ = 0;
+
+public:
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Constructors
+
+    AtomicIntrusivePtr() = default;
+
+    AtomicIntrusivePtr(std::nullptr_t) {
+    }
+
+    AtomicIntrusivePtr(IntrusivePtr<T> ptr) : word_(Word(ptr.Detach())) {
+    }
+
+    AtomicIntrusivePtr(const AtomicIntrusivePtr&) = delete;
+    AtomicIntrusivePtr& operator=(const AtomicIntrusivePtr&) = delete;
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Destructor
+
+    ~AtomicIntrusivePtr() {
+        if (T* ptr = Pointer(word_.load(std::memory_order_acquire))) {
+            ptr->DecRef();
+        }
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Operations
+
+    IntrusivePtr<T> Load() const {
+        uintptr_t word = Lock();
+        IntrusivePtr<T> result(Pointer(word));
+        word_.store(word, std::memory_order_release);
+        return result;
+    }
+
+    void Store(IntrusivePtr<T> desired) {
+        Exchange(std::move(desired));
+    }
+
+    IntrusivePtr<T> Exchange(IntrusivePtr<T> desired) {
+        uintptr_t next = Word(desired.Detach());
+        uintptr_t word = word_.load(std::memory_order_relaxed) & ~kLocked;
+        while (!word_.compare_exchange_weak(word, next, std::memory_order_acq_rel,
+                                            std::memory_order_relaxed)) {
+            word = WaitUnlocked(word);
+        }
+        return IntrusivePtr<T>(Pointer(word), AdoptRef{});
+    }
+
+    // Replace the stored pointer with `desired` if it is `expected`; otherwise load the current
+    // value into `expected`. Never fails spuriously.
+    bool CompareExchange(IntrusivePtr<T>& expected, IntrusivePtr<T> desired) {
+        uintptr_t word = Word(expected.Get());
+        while (true) {
+            if (word_.compare_exchange_strong(word, Word(desired.Get()),
+                                              std::memory_order_acq_rel,
+                                              std::memory_order_acquire)) {
+                (void)desired.Detach();
+                // The slot's reference to the old object goes away; `expected` still holds one.
+                if (T* old = Pointer(word)) {
+                    old->DecRef();
+                }
+                return true;
+            }
+            if ((word & kLocked) == 0) {
+                expected = Load();
+                return false;
+            }
+            // Someone is loading; the value may still match once they are done.
+            word = Word(expected.Get());
+            WaitUnlocked(word_.load(std::memory_order_relaxed));
+        }
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Observers
+
+    // Whether the slot is empty right now; no reference is taken.
+    bool IsNull() const {
+        return Pointer(word_.load(std::memory_order_relaxed)) == nullptr;
+    }
+
+private:
+    static uintptr_t Word(T* ptr) {
+        static_assert(alignof(T) > kLocked, "the lowest pointer bit is used as a spin bit");
+        return reinterpret_cast<uintptr_t>(ptr);
+    }
+
+    static T* Pointer(uintptr_t word) {
+        return reinterpret_cast<T*>(word & ~kLocked);
+    }
+
+    uintptr_t Lock() const {
+        while (true) {
+            uintptr_t word = word_.fetch_or(kLocked, std::memory_order_acquire);
+            if ((word & kLocked) == 0) {
+                return word;
+            }
+            WaitUnlocked(word);
+        }
+    }
+
+    // Spin (reading only, so the cache line stays shared) until the spin bit is clear.
+    uintptr_t WaitUnlocked(uintptr_t word) const {
+        for (size_t spins = 0; (word & kLocked) != 0; ++spins) {
+            if (spins >= 64) {
+                std::this_thread::yield();
+            }
+            word = word_.load(std::memory_order_relaxed);
+        }
+        return word;
+    }
+};
@@ -0,0 +1,107 @@
+#pragma once
+
+#include "intrusive.h"
+
+#include <atomic>
+#include <type_traits>
+#include <utility>  // for std::forward / std::as_const / std::in_place_t
+
+// Heap cell of a `BasicCowPtr`: the value next to its reference counter.
+template <typename T, typename Counter>
+class CowBox : public RefCounted<CowBox<T, Counter>, Counter, DefaultDelete> {
+public:
+    template <typename... Args>
+    explicit CowBox(std::in_place_t, Args&&... args) : value(std::forward<Args>(args)...) {
+    }
+
+    T value;
+};
+
+// Copy-on-write value: copies of the handle share one `T`, reads are plain dereferences, and
+// `Mutate()` clones the value only if someone else still shares it. A request that only reads a
+// config never copies it.
+//
+// A single handle is not thread-safe, but with `AtomicCowPtr` different handles sharing one value
+// may be read, copied and mutated from different threads.
+template <typename T, typename Counter>
+class BasicCowPtr {
+private:
+    using Box = CowBox<T, Counter>;
+
+    IntrusivePtr<Box> box_;
+
+public:
+    // Relocating a handle is a plain byte copy (see `IsTriviallyRelocatable`).
+    using TriviallyRelocatable = std::true_type;
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Constructors
+
+    BasicCowPtr() = default;
+
+    template <typename... Args>
+    explicit BasicCowPtr(std::in_place_t, Args&&... args)
+        : box_(new Box(std::in_place, std::forward<Args>(args)...)) {
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Modifiers
+
+    // Writable access to a value no other handle shares; clones it first if necessary.
+    // The handle must not be empty.
+    T& Mutate() {
+        if (box_->RefCount() != 1) {
+            box_ = IntrusivePtr<Box>(new Box(std::in_place, std::as_const(box_->value)));
+        } else {
+            // Everything the previous owners did with the value happens before our writes.
+            std::atomic_thread_fence(std::memory_order_acquire);
+        }
+        return box_->value;
+    }
+
+    void Reset() {
+        box_.Reset();
+    }
+
+    void Swap(BasicCowPtr& other) noexcept {
+        box_.Swap(other.box_);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Observers
+
+    const T* Get() const {
+        return box_ ? &box_->value : nullptr;
+    }
+    const T& operator*() const {
+        return box_->value;
+    }
+    const T* operator->() const {
+        return &box_->value;
+    }
+
+    // Number of handles sharing the value.
+    size_t UseCount() const {
+        return box_.UseCount();
+    }
+
+    explicit operator bool() const {
+        return static_cast<bool>(box_);
+    }
+};
+
+template <typename T>
+using CowPtr = BasicCowPtr<T, SimpleCounter>;
+
+template <typename T>
+using AtomicCowPtr = BasicCowPtr<T, AtomicCounter>;
+
+template <typename T, typename... Args>
+CowPtr<T> MakeCow(Args&&... args) {
+    return CowPtr<T>(std::in_place, std::forward<Args>(args)...);
+}
+
+template <typename T, typename... Args>
+AtomicCowPtr<T> MakeAtomicCow(Args&&... args) {
+    return AtomicCowPtr<T>(std::in_place, std::forward<Args>(args)...);
+}
@@ -0,0 +1,295 @@
+#pragma once
+
+#include "intrusive.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <utility>  // for std::exchange / std::swap
+#include <vector>
+
+// Epoch-based reclamation for objects that lock-free readers may still be looking at after their
+// last reference is gone.
+//
+// Readers wrap every access in an `EpochGuard`, which pins the current global epoch for the
+// thread. Objects whose deleter is `RetireDelete` are not destroyed by the final `DecRef()`;
+// they go to a per-thread limbo list tagged with the epoch of retirement. The global epoch moves
+// on only when every pinned thread has observed it, so once it is two steps past an object's
+// epoch no reader can still hold a pointer to it, and the object is destroyed for real.
+//
+// One process-wide domain (a deleter has no state to point at another one). A thread that never
+// stops retiring objects frees them in batches; a thread that exits hands its limbo to the others.
+class EpochDomain {
+public:
+    // A thread collects its limbo after retiring this many objects.
+    static constexpr size_t kCollectThreshold = 64;
+
+private:
+    struct Retired {
+        void* object;
+        void (*destroy)(void*);
+        uint64_t epoch;
+    };
+
+    // Per-thread state. Records are never freed before the domain; threads that exit leave theirs
+    // for reuse.
+    struct Record {
+        // Epoch pinned by the owner, zero when it is not inside an `EpochGuard`.
+        std::atomic<uint64_t> pinned = 0;
+        std::atomic<bool> in_use = false;
+        Record* next = nullptr;
+
+        // Owner-only.
+        size_t nesting = 0;
+        std::vector<Retired> limbo;
+        // Limbo size at which the next collection runs. Objects a pinned reader still blocks stay
+        // in the limbo, so collecting once per `kCollectThreshold` new ones keeps retiring O(1)
+        // amortized even while a slow reader holds everything back.
+        size_t next_collect = kCollectThreshold;
+    };
+
+    class ThreadState {
+    public:
+        ~ThreadState() {
+            if (record_ != nullptr) {
+                Instance().Release(std::exchange(record_, nullptr));
+            }
+        }
+
+        Record& Get() {
+            if (record_ == nullptr) {
+                record_ = Instance().Acquire();
+            }
+            return *record_;
+        }
+
+    private:
+        Record* record_ = nullptr;
+    };
+
+    std::atomic<uint64_t> epoch_ = 1;
+    std::atomic<Record*> records_ = nullptr;
+
+    // Limbo of exited threads.
+    std::mutex orphans_mutex_;
+    std::vector<Retired> orphans_;
+
+    // Set at exit, when thread-local state may already be gone and nobody reads any more.
+    std::atomic<bool> exiting_ = false;
+
+    EpochDomain() = default;
+
+public:
+
+    EpochDomain(const EpochDomain&) = delete;
+    EpochDomain& operator=(const EpochDomain&) = delete;
+
+    ~EpochDomain() {
+        // No readers are left at exit.
+        exiting_.store(true, std::memory_order_relaxed);
+        DestroyAll(orphans_);
+        for (Record* record = records_.load(); record != nullptr;) {
+            DestroyAll(record->limbo);
+            delete std::exchange(record, record->next);
+        }
+    }
+
+    static EpochDomain& Instance() {
+        static EpochDomain domain;
+        return domain;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Readers
+
+    void Pin() {
+        Record& record = Local();
+        if (record.nesting++ != 0) {
+            return;
+        }
+        // Publish the epoch, then make sure it was still current afterwards: otherwise the global
+        // epoch could have moved on twice without seeing us.
+        uint64_t epoch = epoch_.load();
+        while (true) {
+            record.pinned.store(epoch);
+            uint64_t current = epoch_.load();
+            if (current == epoch) {
+                break;
+            }
+            epoch = current;
+        }
+    }
+
+    void Unpin() {
+        Record& record = Local();
+        if (--record.nesting == 0) {
+            record.pinned.store(0, std::memory_order_release);
+        }
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Writers
+
+    // Destroy `object` with `destroy` once no thread can be reading it any more.
+    void Retire(void* object, void (*destroy)(void*)) {
+        if (exiting_.load(std::memory_order_relaxed)) {
+            destroy(object);
+            return;
+        }
+        Record& record = Local();
+        record.limbo.push_back(Retired{object, destroy, epoch_.load()});
+        if (record.limbo.size() >= record.next_collect) {
+            // Raised first, so objects retired by the destructors `Collect` runs do not recurse.
+            record.next_collect = record.limbo.size() + kCollectThreshold;
+            TryAdvance();
+            Collect(record);
+            record.next_collect = record.limbo.size() + kCollectThreshold;
+        }
+    }
+
+    // Wait for the readers and destroy everything this thread (and exited threads) retired. Must
+    // not be called inside an `EpochGuard`.
+    void Drain() {
+        Record& record = Local();
+        while (true) {
+            {
+                std::lock_guard guard(orphans_mutex_);
+                record.limbo.insert(record.limbo.end(), orphans_.begin(), orphans_.end());
+                orphans_.clear();
+            }
+            if (record.limbo.empty()) {
+                record.next_collect = kCollectThreshold;
+                return;
+            }
+            TryAdvance();
+            Collect(record);
+            if (!record.limbo.empty()) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Observers
+
+    // Objects retired by this thread and not destroyed yet.
+    size_t Pending() {
+        return Local().limbo.size();
+    }
+
+    uint64_t Epoch() const {
+        return epoch_.load(std::memory_order_relaxed);
+    }
+
+private:
+    static Record& Local() {
+        thread_local ThreadState state;
+        return state.Get();
+    }
+
+    static void DestroyAll(std::vector<Retired>& retired) {
+        // Destructors may retire more objects, so never iterate the live list.
+        while (!retired.empty()) {
+            std::vector<Retired> batch;
+            std::swap(batch, retired);
+            for (const Retired& item : batch) {
+                item.destroy(item.object);
+            }
+        }
+    }
+
+    Record* Acquire() {
+        for (Record* record = records_.load(std::memory_order_acquire); record != nullptr;
+             record = record->next) {
+            bool free = false;
+            if (record->in_use.compare_exchange_strong(free, true)) {
+                return record;
+            }
+        }
+        auto* record = new Record;
+        record->in_use.store(true, std::memory_order_relaxed);
+        record->next = records_.load(std::memory_order_relaxed);
+        while (!records_.compare_exchange_weak(record->next, record, std::memory_order_release,
+                                               std::memory_order_relaxed)) {
+        }
+        return record;
+    }
+
+    void Release(Record* record) {
+        if (!record->limbo.empty()) {
+            std::lock_guard guard(orphans_mutex_);
+            orphans_.insert(orphans_.end(), record->limbo.begin(), record->limbo.end());
+            record->limbo.clear();
+        }
+        record->next_collect = kCollectThreshold;
+        record->pinned.store(0);
+        record->in_use.store(false, std::memory_order_release);
+    }
+
+    // Move the global epoch on if every pinned thread has already observed it.
+    void TryAdvance() {
+        uint64_t epoch = epoch_.load();
+        for (Record* record = records_.load(); record != nullptr; record = record->next) {
+            uint64_t pinned = record->pinned.load();
+            if (pinned != 0 && pinned != epoch) {
+                return;
+            }
+        }
+        epoch_.compare_exchange_strong(epoch, epoch + 1);
+    }
+
+    void Collect(Record& record) {
+        uint64_t epoch = epoch_.load();
+        std::vector<Retired> ready;
+        std::erase_if(record.limbo, [&](const Retired& item) {
+            if (item.epoch + 2 > epoch) {
+                return false;
+            }
+            ready.push_back(item);
+            return true;
+        });
+        if (orphans_mutex_.try_lock()) {
+            std::erase_if(orphans_, [&](const Retired& item) {
+                if (item.epoch + 2 > epoch) {
+                    return false;
+                }
+                ready.push_back(item);
+                return true;
+            });
+            orphans_mutex_.unlock();
+        }
+        DestroyAll(ready);
+    }
+};
+
+// Keeps the calling thread's epoch pinned: objects retired through `RetireDelete` from now on are
+// not destroyed before the guard goes away. Nests freely.
+class EpochGuard {
+public:
+    EpochGuard() {
+        EpochDomain::Instance().Pin();
+    }
+
+    EpochGuard(const EpochGuard&) = delete;
+    EpochGuard& operator=(const EpochGuard&) = delete;
+
+    ~EpochGuard() {
+        EpochDomain::Instance().Unpin();
+    }
+};
+
+// `Deleter` for `RefCounted` that defers the actual destruction (done by `Then`) until no
+// `EpochGuard` that could have seen the object is alive:
+//
+//     struct Node : AtomicRefCounted<Node, RetireDelete<>> { ... };
+template <typename Then = DefaultDelete>
+struct RetireDelete {
+    template <typename T>
+    static void Destroy(T* object) {
+        EpochDomain::Instance().Retire(object, [](void* retired) {
+            Then::Destroy(static_cast<T*>(retired));
+        });
+    }
+};
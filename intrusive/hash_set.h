@@ -0,0 +1,205 @@
+#pragma once
+
+#include "intrusive.h"
+
+#include <cstddef>
+#include <functional>  // for std::hash / std::invoke
+#include <type_traits>
+#include <utility>  // for std::move / std::exchange
+#include <vector>
+
+// Bucket link of one `IntrusiveHashSet<T, Key, Tag>`, embedded in `T` as a base class; see
+// `ListHook` for telling several hooks apart by `Tag`. Not copied with the object.
+template <typename Tag = void>
+class HashSetHook {
+    template <typename T, auto Key, typename Y, typename Hash>
+    friend class IntrusiveHashSet;
+
+public:
+    HashSetHook() = default;
+
+    HashSetHook(const HashSetHook&) {
+    }
+
+    HashSetHook& operator=(const HashSetHook&) {
+        return *this;
+    }
+
+    bool IsLinked() const {
+        return linked_;
+    }
+
+private:
+    HashSetHook* next_ = nullptr;
+    // Cached, so growing the table never calls the hash function again.
+    size_t hash_ = 0;
+    bool linked_ = false;
+};
+
+// Chained hash set of `RefCounted` objects keyed by `Key` (a data member pointer or any callable
+// taking `const T&`), e.g. `IntrusiveHashSet<Connection, &Connection::id>`. Like `IntrusiveList`
+// it owns one reference to each member and allocates nothing per element; the only allocation is
+// the bucket array, which doubles once there are more elements than buckets. Not thread-safe.
+template <typename T, auto Key, typename Tag = void,
+          typename Hash = std::hash<
+              std::remove_cvref_t<std::invoke_result_t<decltype(Key), const T&>>>>
+class IntrusiveHashSet {
+private:
+    using Hook = HashSetHook<Tag>;
+    using KeyType = std::remove_cvref_t<std::invoke_result_t<decltype(Key), const T&>>;
+
+    static_assert(std::is_base_of_v<Hook, T>, "T must derive from HashSetHook<Tag>");
+
+    static constexpr size_t kMinBuckets = 8;
+
+    std::vector<Hook*> buckets_;
+    size_t size_ = 0;
+    [[no_unique_address]] Hash hasher_;
+
+public:
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Constructors
+
+    IntrusiveHashSet() = default;
+
+    explicit IntrusiveHashSet(size_t expected_size) {
+        Rehash(BucketsFor(expected_size));
+    }
+
+    IntrusiveHashSet(const IntrusiveHashSet&) = delete;
+    IntrusiveHashSet& operator=(const IntrusiveHashSet&) = delete;
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Destructor
+
+    ~IntrusiveHashSet() {
+        Clear();
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Modifiers
+
+    // Returns false (and drops `object`) if an element with the same key is already present.
+    // `object` must not be in another set with the same `Tag`.
+    bool Insert(IntrusivePtr<T> object) {
+        size_t hash = hasher_(KeyOf(*object));
+        if (Find(KeyOf(*object), hash) != nullptr) {
+            return false;
+        }
+        if (size_ >= buckets_.size()) {
+            Rehash(buckets_.empty() ? kMinBuckets : 2 * buckets_.size());
+        }
+        Hook* hook = object.Detach();
+        hook->hash_ = hash;
+        hook->linked_ = true;
+        Hook*& bucket = buckets_[hash & (buckets_.size() - 1)];
+        hook->next_ = std::exchange(bucket, hook);
+        ++size_;
+        return true;
+    }
+
+    // Remove the element with `key`, if any, and hand its reference to the caller.
+    IntrusivePtr<T> Erase(const KeyType& key) {
+        T* object = Find(key);
+        return object != nullptr ? Erase(*object) : nullptr;
+    }
+
+    // `object` must be in this set.
+    IntrusivePtr<T> Erase(T& object) {
+        Hook* hook = &static_cast<Hook&>(object);
+        Hook** link = &buckets_[hook->hash_ & (buckets_.size() - 1)];
+        while (*link != hook) {
+            link = &(*link)->next_;
+        }
+        *link = std::exchange(hook->next_, nullptr);
+        hook->linked_ = false;
+        --size_;
+        return IntrusivePtr<T>(&object, AdoptRef{});
+    }
+
+    void Clear() {
+        for (Hook*& bucket : buckets_) {
+            while (Hook* hook = bucket) {
+                bucket = std::exchange(hook->next_, nullptr);
+                hook->linked_ = false;
+                --size_;
+                ToObject(hook)->DecRef();
+            }
+        }
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Observers
+
+    T* Find(const KeyType& key) const {
+        return Empty() ? nullptr : Find(key, hasher_(key));
+    }
+
+    bool Contains(const KeyType& key) const {
+        return Find(key) != nullptr;
+    }
+
+    // Call `callback(T&)` for every element, in no particular order. The set must not be modified
+    // meanwhile.
+    template <typename Callback>
+    void ForEach(Callback&& callback) const {
+        for (Hook* bucket : buckets_) {
+            for (Hook* hook = bucket; hook != nullptr; hook = hook->next_) {
+                callback(*ToObject(hook));
+            }
+        }
+    }
+
+    size_t Size() const {
+        return size_;
+    }
+
+    bool Empty() const {
+        return size_ == 0;
+    }
+
+    size_t BucketCount() const {
+        return buckets_.size();
+    }
+
+private:
+    static T* ToObject(Hook* hook) {
+        return static_cast<T*>(hook);
+    }
+
+    static decltype(auto) KeyOf(const T& object) {
+        return std::invoke(Key, object);
+    }
+
+    static size_t BucketsFor(size_t size) {
+        size_t buckets = kMinBuckets;
+        while (buckets < size) {
+            buckets *= 2;
+        }
+        return buckets;
+    }
+
+    T* Find(const KeyType& key, size_t hash) const {
+        if (buckets_.empty()) {
+            return nullptr;
+        }
+        for (Hook* hook = buckets_[hash & (buckets_.size() - 1)]; hook != nullptr;
+             hook = hook->next_) {
+            if (hook->hash_ == hash && KeyOf(*ToObject(hook)) == key) {
+                return ToObject(hook);
+            }
+        }
+        return nullptr;
+    }
+
+    void Rehash(size_t bucket_count) {
+        std::vector<Hook*> buckets(bucket_count, nullptr);
+        for (Hook* bucket : buckets_) {
+            while (Hook* hook = bucket) {
+                bucket = hook->next_;
+                hook->next_ = std::exchange(buckets[hook->hash_ & (bucket_count - 1)], hook);
+            }
+        }
+        buckets_ = std::move(buckets);
+    }
+};
@@ -1,10 +1,25 @@
 #pragma once
 
+#include <atomic>
 #include <cstddef>  // for std::nullptr_t
+#include <cstdint>
+#include <cstdlib>  // for std::abort
+#include <limits>
+#include <new>
+#include <type_traits>  // for std::true_type
 #include <utility>  // for std::exchange / std::swap
 
+#include <common/trivial_abi.h>
+
+// Counters live inside the object, so copying the object must not copy the count: a copy starts
+// from zero and assignment leaves the count alone.
 class SimpleCounter {
 public:
+    SimpleCounter() = default;
+
+    SimpleCounter(const SimpleCounter&) {
+    }
+
     size_t IncRef() {
         return ++count_;
     }
@@ -27,6 +42,145 @@ private:
     size_t count_ = 0;
 };
 
+// Thread-safe counter. Increments need no ordering (the caller already holds a reference); the
+// decrement that reaches zero synchronizes with all earlier ones, so every write to the object
+// happens before its destruction.
+class AtomicCounter {
+public:
+    AtomicCounter() = default;
+
+    AtomicCounter(const AtomicCounter&) {
+    }
+
+    size_t IncRef() {
+        return count_.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+    size_t DecRef() {
+        size_t count = count_.fetch_sub(1, std::memory_order_release) - 1;
+        if (count == 0) {
+            std::atomic_thread_fence(std::memory_order_acquire);
+        }
+        return count;
+    }
+    size_t RefCount() const {
+        return count_.load(std::memory_order_relaxed);
+    }
+
+    AtomicCounter& operator=(const AtomicCounter&) {
+        return *this;
+    }
+
+private:
+    std::atomic<size_t> count_ = 0;
+};
+
+// What a compact counter does when one more reference would not fit.
+enum class CounterOverflow {
+    // Stick at the maximum: the object becomes immortal and is leaked instead of freed too early.
+    kSaturate,
+    // Abort the process.
+    kTrap,
+};
+
+// `SimpleCounter` in 32 or 16 bits, for small dense nodes where 8 bytes of counter (plus padding)
+// is a noticeable share of the object.
+template <typename Int, CounterOverflow Overflow = CounterOverflow::kSaturate>
+    requires(std::is_unsigned_v<Int> && sizeof(Int) < sizeof(size_t))
+class CompactCounter {
+public:
+    static constexpr Int kMax = std::numeric_limits<Int>::max();
+
+    CompactCounter() = default;
+
+    CompactCounter(const CompactCounter&) {
+    }
+
+    size_t IncRef() {
+        if (count_ == kMax) {
+            Overflowed();
+            return kMax;
+        }
+        return ++count_;
+    }
+    size_t DecRef() {
+        if (Overflow == CounterOverflow::kSaturate && count_ == kMax) {
+            return kMax;
+        }
+        return --count_;
+    }
+    size_t RefCount() const {
+        return count_;
+    }
+
+    CompactCounter& operator=(const CompactCounter&) {
+        return *this;
+    }
+
+private:
+    static void Overflowed() {
+        if constexpr (Overflow == CounterOverflow::kTrap) {
+            std::abort();
+        }
+    }
+
+    Int count_ = 0;
+};
+
+// Atomic counterpart of `CompactCounter`, with the same memory ordering as `AtomicCounter`.
+template <typename Int, CounterOverflow Overflow = CounterOverflow::kSaturate>
+    requires(std::is_unsigned_v<Int> && sizeof(Int) < sizeof(size_t))
+class AtomicCompactCounter {
+public:
+    static constexpr Int kMax = std::numeric_limits<Int>::max();
+
+    AtomicCompactCounter() = default;
+
+    AtomicCompactCounter(const AtomicCompactCounter&) {
+    }
+
+    size_t IncRef() {
+        Int count = count_.load(std::memory_order_relaxed);
+        do {
+            if (count == kMax) {
+                if constexpr (Overflow == CounterOverflow::kTrap) {
+                    std::abort();
+                }
+                return kMax;
+            }
+        } while (!count_.compare_exchange_weak(count, count + 1, std::memory_order_relaxed));
+        return count + 1;
+    }
+    size_t DecRef() {
+        Int count;
+        if constexpr (Overflow == CounterOverflow::kSaturate) {
+            count = count_.load(std::memory_order_relaxed);
+            do {
+                if (count == kMax) {
+                    return kMax;
+                }
+            } while (!count_.compare_exchange_weak(count, count - 1, std::memory_order_release,
+                                                   std::memory_order_relaxed));
+            --count;
+        } else {
+            count = count_.fetch_sub(1, std::memory_order_release) - 1;
+        }
+        if (count == 0) {
+            std::atomic_thread_fence(std::memory_order_acquire);
+        }
+        return count;
+    }
+    size_t RefCount() const {
+        return count_.load(std::memory_order_relaxed);
+    }
+
+    AtomicCompactCounter& operator=(const AtomicCompactCounter&) {
+        return *this;
+    }
+
+private:
+    std::atomic<Int> count_ = 0;
+};
+
 struct DefaultDelete {
     template <typename T>
     static void Destroy(T* object) {
@@ -37,6 +191,12 @@ struct DefaultDelete {
 template <typename Derived, typename Counter, typename Deleter>
 class RefCounted {
 public:
+    // Layout hint: bytes between the counter and the next pointer-aligned offset. `Derived` members
+    // are laid out right after the counter, so declaring this many bytes of small members first
+    // (keys, flags, colors) fills the gap instead of wasting it on padding.
+    static constexpr size_t kCounterPadding =
+        (alignof(void*) - sizeof(Counter) % alignof(void*)) % alignof(void*);
+
     // Increase reference counter.
     void IncRef() {
         counter_.IncRef();
@@ -45,8 +205,7 @@ public:
     // Decrease reference counter.
     // Destroy object using Deleter when the last instance dies.
     void DecRef() {
-        counter_.DecRef();
-        if (RefCount() == 0) {
+        if (counter_.DecRef() == 0) {
             Deleter::Destroy(static_cast<Derived*>(this));
         }
     }
@@ -63,8 +222,114 @@ private:
 template <typename Derived, typename D = DefaultDelete>
 using SimpleRefCounted = RefCounted<Derived, SimpleCounter, D>;
 
+template <typename Derived, typename D = DefaultDelete>
+using AtomicRefCounted = RefCounted<Derived, AtomicCounter, D>;
+
+template <typename Derived, typename D = DefaultDelete>
+using CompactRefCounted = RefCounted<Derived, CompactCounter<uint32_t>, D>;
+
+template <typename Derived, typename D = DefaultDelete>
+using AtomicCompactRefCounted = RefCounted<Derived, AtomicCompactCounter<uint32_t>, D>;
+
+// Counts of an object with weak references. They outlive the object itself: the destructor runs
+// when `strong` drops to zero, the memory is freed when `weak` does. All strong references together
+// hold one weak reference, so the memory cannot go away while the destructor runs.
+struct IntrusiveWeakCounts {
+    std::atomic<size_t> strong = 0;
+    std::atomic<size_t> weak = 1;
+    // Set on construction; read once the object is gone.
+    void* allocation = nullptr;
+    void (*deallocate)(void* allocation) = nullptr;
+
+    // Increment if not zero: the single step that promotes a weak reference.
+    bool TryIncStrong() {
+        size_t count = strong.load(std::memory_order_relaxed);
+        while (count != 0) {
+            if (strong.compare_exchange_weak(count, count + 1, std::memory_order_acquire,
+                                             std::memory_order_relaxed)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void IncWeak() {
+        weak.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void DecWeak() {
+        if (weak.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            deallocate(allocation);
+        }
+    }
+};
+
+// Mixin for objects that can be observed by `IntrusiveWeakPtr`. Thread-safe, like
+// `AtomicRefCounted`. The counts sit in raw storage inside the object, which is not touched by the
+// destructor and stays valid until the last weak reference lets go of the memory.
+// Objects must be allocated with plain `new` (e.g. via `MakeIntrusive`), and `Derived` must be
+// the most-derived type: the memory is freed as a `Derived` at the address of the `Derived`.
+template <typename Derived>
+class RefCountedWithWeak {
+public:
+    RefCountedWithWeak() {
+        auto* counts = new (counts_storage_) IntrusiveWeakCounts;
+        // Stored up front rather than right before the destructor, where the compiler may treat
+        // writes into an object about to die as dead.
+        counts->allocation = static_cast<Derived*>(this);
+        counts->deallocate = &Free;
+    }
+
+    RefCountedWithWeak(const RefCountedWithWeak&) : RefCountedWithWeak() {
+    }
+
+    RefCountedWithWeak& operator=(const RefCountedWithWeak&) {
+        return *this;
+    }
+
+    void IncRef() {
+        Counts()->strong.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void DecRef() {
+        IntrusiveWeakCounts* counts = Counts();
+        if (counts->strong.fetch_sub(1, std::memory_order_release) != 1) {
+            return;
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        static_cast<Derived*>(this)->~Derived();
+        counts->DecWeak();
+    }
+
+    size_t RefCount() const {
+        return Counts()->strong.load(std::memory_order_relaxed);
+    }
+
+    IntrusiveWeakCounts* Counts() const {
+        return std::launder(
+            reinterpret_cast<IntrusiveWeakCounts*>(const_cast<unsigned char*>(counts_storage_)));
+    }
+
+private:
+    static void Free(void* allocation) {
+        if constexpr (alignof(Derived) > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+            ::operator delete(allocation, std::align_val_t(alignof(Derived)));
+        } else {
+            ::operator delete(allocation);
+        }
+    }
+
+    alignas(IntrusiveWeakCounts) unsigned char counts_storage_[sizeof(IntrusiveWeakCounts)];
+};
+
+// Tag for `IntrusivePtr(ptr, AdoptRef{})`: take over a reference the caller already owns (e.g. one
+// given up by `Detach()`) instead of adding a new one.
+struct AdoptRef {
+    explicit AdoptRef() = default;
+};
+
 template <typename T>
-class IntrusivePtr {
+class SMART_PTRS_TRIVIAL_ABI IntrusivePtr {
     template <typename Y>
     friend class IntrusivePtr;
 
@@ -72,6 +337,9 @@ private:
     T* ptr_ = nullptr;
 
 public:
+    // Relocating a handle is a plain byte copy (see `IsTriviallyRelocatable`).
+    using TriviallyRelocatable = std::true_type;
+
     // Constructors
     IntrusivePtr() {
     }
@@ -85,6 +353,9 @@ public:
         }
     }
 
+    IntrusivePtr(T* ptr, AdoptRef) noexcept : ptr_(ptr) {
+    }
+
     template <typename Y>
     IntrusivePtr(const IntrusivePtr<Y>& other) : ptr_(other.ptr_) {
         if (ptr_ != nullptr) {
@@ -93,7 +364,7 @@ public:
     }
 
     template <typename Y>
-    IntrusivePtr(IntrusivePtr<Y>&& other) : ptr_(other.ptr_) {
+    IntrusivePtr(IntrusivePtr<Y>&& other) noexcept : ptr_(other.ptr_) {
         other.ptr_ = nullptr;
     }
 
@@ -103,7 +374,7 @@ public:
         }
     }
 
-    IntrusivePtr(IntrusivePtr&& other) : ptr_(other.ptr_) {
+    IntrusivePtr(IntrusivePtr&& other) noexcept : ptr_(other.ptr_) {
         other.ptr_ = nullptr;
     }
 
@@ -121,7 +392,7 @@ public:
         return *this;
     }
 
-    IntrusivePtr& operator=(IntrusivePtr&& other) {
+    IntrusivePtr& operator=(IntrusivePtr&& other) noexcept {
         if (ptr_ == other.ptr_) {
             return *this;
         }
@@ -145,7 +416,7 @@ public:
     }
 
     template <typename S>
-    IntrusivePtr& operator=(IntrusivePtr<S>&& other) {
+    IntrusivePtr& operator=(IntrusivePtr<S>&& other) noexcept {
         if (ptr_ == other.ptr_) {
             return *this;
         }
@@ -179,10 +450,16 @@ public:
         }
     }
 
-    void Swap(IntrusivePtr& other) {
+    void Swap(IntrusivePtr& other) noexcept {
         std::swap(ptr_, other.ptr_);
     }
 
+    // Give up the reference without decrementing; the caller now owns it and must eventually pass
+    // it back via `AdoptRef` or call `DecRef()` itself.
+    [[nodiscard]] T* Detach() noexcept {
+        return std::exchange(ptr_, nullptr);
+    }
+
     // Observers
     T* Get() const {
         return ptr_;
@@ -211,3 +488,86 @@ template <typename T, typename... Args>
 IntrusivePtr<T> MakeIntrusive(Args&&... args) {
     return IntrusivePtr<T>(new T(std::forward<Args>(args)...));
 }
+
+// Weak reference to an object derived from `RefCountedWithWeak`. No separate control block: the
+// pointer keeps the object's memory (and its counts) alive, not the object.
+template <typename T>
+class IntrusiveWeakPtr {
+    template <typename Y>
+    friend class IntrusiveWeakPtr;
+
+private:
+    T* ptr_ = nullptr;
+    IntrusiveWeakCounts* counts_ = nullptr;
+
+public:
+    // Relocating a handle is a plain byte copy (see `IsTriviallyRelocatable`).
+    using TriviallyRelocatable = std::true_type;
+
+    // Constructors
+    IntrusiveWeakPtr() {
+    }
+
+    template <typename Y>
+    IntrusiveWeakPtr(const IntrusivePtr<Y>& other) : ptr_(other.Get()) {
+        if (ptr_ != nullptr) {
+            counts_ = ptr_->Counts();
+            counts_->IncWeak();
+        }
+    }
+
+    IntrusiveWeakPtr(const IntrusiveWeakPtr& other) : ptr_(other.ptr_), counts_(other.counts_) {
+        if (counts_ != nullptr) {
+            counts_->IncWeak();
+        }
+    }
+
+    IntrusiveWeakPtr(IntrusiveWeakPtr&& other) noexcept
+        : ptr_(std::exchange(other.ptr_, nullptr)), counts_(std::exchange(other.counts_, nullptr)) {
+    }
+
+    // `operator=`-s
+    IntrusiveWeakPtr& operator=(const IntrusiveWeakPtr& other) {
+        IntrusiveWeakPtr(other).Swap(*this);
+        return *this;
+    }
+
+    IntrusiveWeakPtr& operator=(IntrusiveWeakPtr&& other) noexcept {
+        IntrusiveWeakPtr(std::move(other)).Swap(*this);
+        return *this;
+    }
+
+    // Destructor
+    ~IntrusiveWeakPtr() {
+        Reset();
+    }
+
+    // Modifiers
+    void Reset() {
+        if (counts_ != nullptr) {
+            std::exchange(counts_, nullptr)->DecWeak();
+        }
+        ptr_ = nullptr;
+    }
+
+    void Swap(IntrusiveWeakPtr& other) noexcept {
+        std::swap(ptr_, other.ptr_);
+        std::swap(counts_, other.counts_);
+    }
+
+    // Observers
+    IntrusivePtr<T> Lock() const {
+        if (counts_ != nullptr && counts_->TryIncStrong()) {
+            return IntrusivePtr<T>(ptr_, AdoptRef{});
+        }
+        return nullptr;
+    }
+
+    size_t UseCount() const {
+        return counts_ != nullptr ? counts_->strong.load(std::memory_order_relaxed) : 0;
+    }
+
+    bool Expired() const {
+        return UseCount() == 0;
+    }
+};
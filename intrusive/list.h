@@ -0,0 +1,223 @@
+#pragma once
+
+#include "intrusive.h"
+
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <utility>  // for std::move
+
+// Links of one `IntrusiveList<T, Tag>`, embedded in `T` as a base class. An object can sit in
+// several lists at once by deriving from one hook per list, told apart by `Tag`:
+//
+//     struct ByDeadline;
+//     struct ByOwner;
+//     struct Timer : AtomicRefCounted<Timer>, ListHook<ByDeadline>, ListHook<ByOwner> { ... };
+//
+// Like the counters, hooks are not copied: a copy of a linked object starts unlinked.
+template <typename Tag = void>
+class ListHook {
+    template <typename T, typename Y>
+    friend class IntrusiveList;
+
+public:
+    ListHook() = default;
+
+    ListHook(const ListHook&) {
+    }
+
+    ListHook& operator=(const ListHook&) {
+        return *this;
+    }
+
+    bool IsLinked() const {
+        return next_ != nullptr;
+    }
+
+private:
+    ListHook* prev_ = nullptr;
+    ListHook* next_ = nullptr;
+};
+
+// Doubly linked list of `RefCounted` objects that owns one reference to each of them, so
+// membership alone keeps an object alive and linking needs no allocation. Not thread-safe.
+template <typename T, typename Tag = void>
+class IntrusiveList {
+private:
+    using Hook = ListHook<Tag>;
+
+    static_assert(std::is_base_of_v<Hook, T>, "T must derive from ListHook<Tag>");
+
+    // Circular, so the empty list and both ends need no special cases.
+    Hook head_;
+    size_t size_ = 0;
+
+public:
+    template <bool Const>
+    class Iterator {
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<Const, const T*, T*>;
+        using reference = std::conditional_t<Const, const T&, T&>;
+
+        Iterator() = default;
+
+        reference operator*() const {
+            return *ToObject(hook_);
+        }
+        pointer operator->() const {
+            return ToObject(hook_);
+        }
+
+        Iterator& operator++() {
+            hook_ = hook_->next_;
+            return *this;
+        }
+        Iterator operator++(int) {
+            Iterator old = *this;
+            ++*this;
+            return old;
+        }
+        Iterator& operator--() {
+            hook_ = hook_->prev_;
+            return *this;
+        }
+        Iterator operator--(int) {
+            Iterator old = *this;
+            --*this;
+            return old;
+        }
+
+        bool operator==(const Iterator&) const = default;
+
+    private:
+        friend class IntrusiveList;
+
+        explicit Iterator(Hook* hook) : hook_(hook) {
+        }
+
+        Hook* hook_ = nullptr;
+    };
+
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Constructors
+
+    IntrusiveList() {
+        head_.prev_ = head_.next_ = &head_;
+    }
+
+    IntrusiveList(const IntrusiveList&) = delete;
+    IntrusiveList& operator=(const IntrusiveList&) = delete;
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Destructor
+
+    ~IntrusiveList() {
+        Clear();
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Modifiers
+
+    // `object` must not be in a list with the same `Tag` already.
+    void PushFront(IntrusivePtr<T> object) {
+        LinkBefore(head_.next_, std::move(object));
+    }
+
+    void PushBack(IntrusivePtr<T> object) {
+        LinkBefore(&head_, std::move(object));
+    }
+
+    // Link `object` right before `position`.
+    iterator Insert(iterator position, IntrusivePtr<T> object) {
+        return iterator(LinkBefore(position.hook_, std::move(object)));
+    }
+
+    IntrusivePtr<T> PopFront() {
+        return Empty() ? nullptr : Erase(*ToObject(head_.next_));
+    }
+
+    IntrusivePtr<T> PopBack() {
+        return Empty() ? nullptr : Erase(*ToObject(head_.prev_));
+    }
+
+    // Unlink `object`, which must be in this list, and hand its reference to the caller.
+    IntrusivePtr<T> Erase(T& object) {
+        Hook* hook = &static_cast<Hook&>(object);
+        hook->prev_->next_ = hook->next_;
+        hook->next_->prev_ = hook->prev_;
+        hook->prev_ = hook->next_ = nullptr;
+        --size_;
+        return IntrusivePtr<T>(&object, AdoptRef{});
+    }
+
+    // Move `object`, which must be in this list, to the back: e.g. touching an LRU entry or
+    // re-arming a timer. Costs no reference counting.
+    void MoveToBack(T& object) {
+        Hook* hook = &static_cast<Hook&>(object);
+        hook->prev_->next_ = hook->next_;
+        hook->next_->prev_ = hook->prev_;
+        hook->prev_ = head_.prev_;
+        hook->next_ = &head_;
+        head_.prev_->next_ = hook;
+        head_.prev_ = hook;
+    }
+
+    void Clear() {
+        while (!Empty()) {
+            PopFront();
+        }
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Observers
+
+    T* Front() const {
+        return Empty() ? nullptr : ToObject(head_.next_);
+    }
+
+    T* Back() const {
+        return Empty() ? nullptr : ToObject(head_.prev_);
+    }
+
+    size_t Size() const {
+        return size_;
+    }
+
+    bool Empty() const {
+        return size_ == 0;
+    }
+
+    iterator begin() {
+        return iterator(head_.next_);
+    }
+    iterator end() {
+        return iterator(&head_);
+    }
+    const_iterator begin() const {
+        return const_iterator(head_.next_);
+    }
+    const_iterator end() const {
+        return const_iterator(const_cast<Hook*>(&head_));
+    }
+
+private:
+    static T* ToObject(Hook* hook) {
+        return static_cast<T*>(hook);
+    }
+
+    Hook* LinkBefore(Hook* next, IntrusivePtr<T> object) {
+        Hook* hook = object.Detach();
+        hook->prev_ = next->prev_;
+        hook->next_ = next;
+        next->prev_->next_ = hook;
+        next->prev_ = hook;
+        ++size_;
+        return hook;
+    }
+};
@@ -0,0 +1,306 @@
+#pragma once
+
+#include "intrusive.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <utility>  // for std::forward / std::exchange
+
+template <typename T>
+class IntrusiveObjectPool;
+
+// `Deleter` for `RefCounted` that hands dead objects back to `IntrusiveObjectPool<T>`:
+//
+//     struct Message : AtomicRefCounted<Message, PooledDelete> { ... };
+//     IntrusivePtr<Message> message = IntrusiveObjectPool<Message>::Instance().Make(...);
+struct PooledDelete {
+    template <typename T>
+    static void Destroy(T* object) {
+        object->~T();
+        IntrusiveObjectPool<T>::Instance().Recycle(object);
+    }
+};
+
+// Process-wide pool of storage for `T` (one per type, because `Deleter::Destroy` has no state).
+//
+// Free storage is kept in magazines - small arrays of node pointers. Every thread owns one
+// magazine, so most allocations and recycles touch nothing shared. Only when its magazine runs
+// empty (or full) does a thread swap it for a full (or empty) one from a global lock-free stack.
+// Magazines are never freed before the pool, and the stacks are ABA-safe tagged indices into the
+// magazine table.
+//
+// Node storage is allocated exactly like `new T`, so objects created with plain `new` may be
+// recycled as well.
+template <typename T>
+class IntrusiveObjectPool {
+private:
+    static constexpr size_t kMagazineSize = 32;
+    static constexpr size_t kChunkSize = 256;
+    static constexpr size_t kMaxChunks = 4096;
+
+    struct Magazine {
+        uint32_t index;
+        std::atomic<uint32_t> next{0};
+        size_t size = 0;
+        void* slots[kMagazineSize];
+
+        bool Full() const {
+            return size == kMagazineSize;
+        }
+    };
+
+    // Treiber stack of magazines. The head packs a version tag (high half) next to the index of
+    // the top magazine plus one (low half, zero for "empty").
+    class MagazineStack {
+    public:
+        void Push(Magazine* magazine) {
+            uint64_t head = head_.load(std::memory_order_relaxed);
+            uint64_t next;
+            do {
+                magazine->next.store(static_cast<uint32_t>(head), std::memory_order_relaxed);
+                next = (Tag(head) + 1) << 32 | (magazine->index + 1);
+            } while (!head_.compare_exchange_weak(head, next, std::memory_order_release,
+                                                  std::memory_order_relaxed));
+        }
+
+        Magazine* Pop(IntrusiveObjectPool& pool) {
+            uint64_t head = head_.load(std::memory_order_acquire);
+            while (static_cast<uint32_t>(head) != 0) {
+                Magazine* magazine = pool.MagazineAt(static_cast<uint32_t>(head) - 1);
+                uint64_t next = (Tag(head) + 1) << 32 |
+                                magazine->next.load(std::memory_order_relaxed);
+                if (head_.compare_exchange_weak(head, next, std::memory_order_acquire,
+                                                std::memory_order_acquire)) {
+                    return magazine;
+                }
+            }
+            return nullptr;
+        }
+
+    private:
+        static uint64_t Tag(uint64_t head) {
+            return head >> 32;
+        }
+
+        std::atomic<uint64_t> head_ = 0;
+    };
+
+    struct ThreadCache {
+        Magazine* magazine = nullptr;
+        size_t hits = 0;
+        size_t misses = 0;
+
+        ~ThreadCache() {
+            IntrusiveObjectPool& pool = Instance();
+            pool.FlushStats(*this);
+            if (magazine == nullptr) {
+                return;
+            }
+            if (magazine->size != 0) {
+                // Same accounting and capacity bound as a magazine given back while running.
+                pool.GiveBack(magazine);
+            } else {
+                pool.empty_.Push(magazine);
+            }
+        }
+    };
+
+    MagazineStack full_;
+    MagazineStack empty_;
+    // Nodes in `full_`; compared against `capacity_` when a thread gives a magazine back.
+    std::atomic<size_t> retained_ = 0;
+    std::atomic<size_t> capacity_ = SIZE_MAX;
+    std::atomic<size_t> hits_ = 0;
+    std::atomic<size_t> misses_ = 0;
+
+    std::atomic<Magazine*> chunks_[kMaxChunks] = {};
+    std::mutex grow_mutex_;
+    uint32_t num_magazines_ = 0;
+
+    IntrusiveObjectPool() = default;
+
+public:
+    struct Stats {
+        // Objects created from recycled storage.
+        size_t hits;
+        // Objects that needed a fresh allocation.
+        size_t misses;
+    };
+
+    IntrusiveObjectPool(const IntrusiveObjectPool&) = delete;
+    IntrusiveObjectPool& operator=(const IntrusiveObjectPool&) = delete;
+
+    ~IntrusiveObjectPool() {
+        for (auto& chunk : chunks_) {
+            Magazine* magazines = chunk.load(std::memory_order_relaxed);
+            if (magazines == nullptr) {
+                break;
+            }
+            for (size_t i = 0; i < kChunkSize; ++i) {
+                for (size_t j = 0; j < magazines[i].size; ++j) {
+                    Deallocate(magazines[i].slots[j]);
+                }
+            }
+            delete[] magazines;
+        }
+    }
+
+    static IntrusiveObjectPool& Instance() {
+        static IntrusiveObjectPool pool;
+        return pool;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Objects
+
+    template <typename... Args>
+    IntrusivePtr<T> Make(Args&&... args) {
+        void* node = Acquire();
+        try {
+            return IntrusivePtr<T>(new (node) T(std::forward<Args>(args)...));
+        } catch (...) {
+            Recycle(node);
+            throw;
+        }
+    }
+
+    // Take back the storage of a destroyed `T` (see `PooledDelete`).
+    void Recycle(void* node) {
+        ThreadCache& cache = LocalCache();
+        if (cache.magazine == nullptr) {
+            cache.magazine = TakeEmptyMagazine();
+        } else if (cache.magazine->Full()) {
+            GiveBack(cache.magazine);
+            FlushStats(cache);
+            cache.magazine = TakeEmptyMagazine();
+        }
+        cache.magazine->slots[cache.magazine->size++] = node;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Tuning
+
+    // Pre-allocate storage for `count` objects, e.g. at startup.
+    void Reserve(size_t count) {
+        while (count > 0) {
+            Magazine* magazine = TakeEmptyMagazine();
+            for (; !magazine->Full() && count > 0; --count) {
+                magazine->slots[magazine->size++] = Allocate();
+            }
+            retained_.fetch_add(magazine->size, std::memory_order_relaxed);
+            full_.Push(magazine);
+        }
+    }
+
+    // Upper bound on storage kept in the shared stacks. Magazines returned beyond it are freed.
+    // Each thread additionally caches up to one magazine.
+    void SetCapacity(size_t capacity) {
+        capacity_.store(capacity, std::memory_order_relaxed);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Observers
+
+    // Approximate: other threads publish their counts only when they swap magazines or exit.
+    Stats GetStats() {
+        FlushStats(LocalCache());
+        return Stats{hits_.load(std::memory_order_relaxed),
+                     misses_.load(std::memory_order_relaxed)};
+    }
+
+    size_t Retained() const {
+        return retained_.load(std::memory_order_relaxed);
+    }
+
+private:
+    static ThreadCache& LocalCache() {
+        thread_local ThreadCache cache;
+        return cache;
+    }
+
+    static void* Allocate() {
+        if constexpr (alignof(T) > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+            return ::operator new(sizeof(T), std::align_val_t(alignof(T)));
+        } else {
+            return ::operator new(sizeof(T));
+        }
+    }
+
+    static void Deallocate(void* node) {
+        if constexpr (alignof(T) > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+            ::operator delete(node, std::align_val_t(alignof(T)));
+        } else {
+            ::operator delete(node);
+        }
+    }
+
+    void* Acquire() {
+        ThreadCache& cache = LocalCache();
+        if (cache.magazine == nullptr || cache.magazine->size == 0) {
+            Magazine* full = full_.Pop(*this);
+            if (full == nullptr) {
+                ++cache.misses;
+                return Allocate();
+            }
+            retained_.fetch_sub(full->size, std::memory_order_relaxed);
+            if (cache.magazine != nullptr) {
+                empty_.Push(cache.magazine);
+            }
+            cache.magazine = full;
+            FlushStats(cache);
+        }
+        ++cache.hits;
+        return cache.magazine->slots[--cache.magazine->size];
+    }
+
+    void GiveBack(Magazine* magazine) {
+        size_t retained = retained_.load(std::memory_order_relaxed);
+        if (retained + magazine->size > capacity_.load(std::memory_order_relaxed)) {
+            for (size_t i = 0; i < magazine->size; ++i) {
+                Deallocate(magazine->slots[i]);
+            }
+            magazine->size = 0;
+            empty_.Push(magazine);
+            return;
+        }
+        retained_.fetch_add(magazine->size, std::memory_order_relaxed);
+        full_.Push(magazine);
+    }
+
+    void FlushStats(ThreadCache& cache) {
+        if (cache.hits != 0) {
+            hits_.fetch_add(std::exchange(cache.hits, 0), std::memory_order_relaxed);
+        }
+        if (cache.misses != 0) {
+            misses_.fetch_add(std::exchange(cache.misses, 0), std::memory_order_relaxed);
+        }
+    }
+
+    Magazine* TakeEmptyMagazine() {
+        if (Magazine* magazine = empty_.Pop(*this)) {
+            return magazine;
+        }
+        std::lock_guard guard(grow_mutex_);
+        uint32_t index = num_magazines_;
+        if (index / kChunkSize == kMaxChunks) {
+            throw std::bad_alloc();
+        }
+        Magazine* chunk = chunks_[index / kChunkSize].load(std::memory_order_relaxed);
+        if (chunk == nullptr) {
+            chunk = new Magazine[kChunkSize];
+            for (size_t i = 0; i < kChunkSize; ++i) {
+                chunk[i].index = static_cast<uint32_t>(index + i);
+            }
+            chunks_[index / kChunkSize].store(chunk, std::memory_order_release);
+        }
+        ++num_magazines_;
+        return &chunk[index % kChunkSize];
+    }
+
+    Magazine* MagazineAt(uint32_t index) {
+        return &chunks_[index / kChunkSize].load(std::memory_order_acquire)[index % kChunkSize];
+    }
+};
@@ -4,7 +4,12 @@
 
 #include "allocations_checker.h"
 
+#include <common/relocatable.h>
+
+#include <atomic>
 #include <string>
+#include <thread>
+#include <vector>
 
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -87,6 +92,21 @@ TEST_CASE("Copy/move") {
     }
 }
 
+TEST_CASE("Relocation") {
+    static_assert(std::is_nothrow_move_constructible_v<IntrusivePtr<MyInt>>);
+    static_assert(std::is_nothrow_move_assignable_v<IntrusivePtr<MyInt>>);
+    static_assert(kIsTriviallyRelocatable<IntrusivePtr<MyInt>>);
+
+    auto p = MakeIntrusive<MyInt>(42);
+    RelocatingVector<IntrusivePtr<MyInt>> ptrs;
+    for (int i = 0; i < 1000; ++i) {
+        ptrs.PushBack(p);
+    }
+    REQUIRE(p.UseCount() == 1001);
+    ptrs = RelocatingVector<IntrusivePtr<MyInt>>();
+    REQUIRE(p.UseCount() == 1);
+}
+
 TEST_CASE("Conversions") {
     struct Foo : SimpleRefCounted<Foo> {
         virtual ~Foo() = default;
@@ -250,6 +270,30 @@ TEST_CASE("From raw pointer") {
     REQUIRE(str->RefCount() == 4);
 }
 
+TEST_CASE("Adopt and detach") {
+    auto a = MakeIntrusive<MyString>("handoff");
+    MyString* raw = a.Get();
+
+    // Round trip through a raw-pointer queue without touching the counter.
+    std::vector<MyString*> queue;
+    queue.push_back(a.Detach());
+    REQUIRE(!a);
+    REQUIRE(raw->RefCount() == 1);
+
+    IntrusivePtr<MyString> b(queue.back(), AdoptRef{});
+    queue.pop_back();
+    REQUIRE(b.Get() == raw);
+    REQUIRE(b.UseCount() == 1);
+
+    IntrusivePtr<MyString> c(b.Get());
+    REQUIRE(b.UseCount() == 2);
+
+    IntrusivePtr<MyString> empty;
+    REQUIRE(empty.Detach() == nullptr);
+    IntrusivePtr<MyString> adopted_null(nullptr, AdoptRef{});
+    REQUIRE(!adopted_null);
+}
+
 struct Pinned : SimpleRefCounted<Pinned> {
     Pinned(int tag) : tag_(tag) {
     }
@@ -270,6 +314,173 @@ private:
     int tag_;
 };
 
+struct Shared : public AtomicRefCounted<Shared> {
+    ~Shared() {
+        ++destroyed;
+    }
+
+    int value = 0;
+
+    static inline std::atomic<int> destroyed = 0;
+};
+
+TEST_CASE("Counter is not copied") {
+    IntrusivePtr<MyString> p(new MyString("abc"));
+    IntrusivePtr<MyString> q = p;
+    IntrusivePtr<MyString> copy(new MyString(*p));
+    REQUIRE(p->RefCount() == 2);
+    REQUIRE(copy->RefCount() == 1);
+
+    *copy = *p;
+    REQUIRE(copy->RefCount() == 1);
+}
+
+TEST_CASE("Atomic counter") {
+    constexpr int kThreads = 4;
+    constexpr int kIterations = 100'000;
+
+    Shared::destroyed = 0;
+    {
+        IntrusivePtr<Shared> root(new Shared);
+        std::vector<std::thread> threads;
+        for (int i = 0; i < kThreads; ++i) {
+            threads.emplace_back([copy = root]() {
+                for (int j = 0; j < kIterations; ++j) {
+                    IntrusivePtr<Shared> local = copy;
+                    IntrusivePtr<Shared> moved = std::move(local);
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        REQUIRE(root->RefCount() == 1);
+    }
+    REQUIRE(Shared::destroyed == 1);
+}
+
+template <typename Counter>
+struct TreeNode : public RefCounted<TreeNode<Counter>, Counter, DefaultDelete> {
+    uint32_t key = 0;
+    TreeNode* left = nullptr;
+    TreeNode* right = nullptr;
+};
+
+TEST_CASE("Compact counters") {
+    SECTION("Layout") {
+        static_assert(TreeNode<CompactCounter<uint32_t>>::kCounterPadding == 4);
+        static_assert(TreeNode<CompactCounter<uint16_t>>::kCounterPadding == 6);
+        static_assert(TreeNode<SimpleCounter>::kCounterPadding == 0);
+        // The key shares the word with the counter.
+        REQUIRE(sizeof(TreeNode<CompactCounter<uint32_t>>) == 3 * sizeof(void*));
+        REQUIRE(sizeof(TreeNode<AtomicCompactCounter<uint16_t>>) == 3 * sizeof(void*));
+        REQUIRE(sizeof(TreeNode<SimpleCounter>) == 4 * sizeof(void*));
+    }
+
+    SECTION("Ownership") {
+        using Node = TreeNode<AtomicCompactCounter<uint32_t, CounterOverflow::kTrap>>;
+        IntrusivePtr<Node> a(new Node);
+        IntrusivePtr<Node> b = a;
+        REQUIRE(a.UseCount() == 2);
+        b.Reset();
+        REQUIRE(a.UseCount() == 1);
+    }
+
+    SECTION("Saturation") {
+        CompactCounter<uint16_t> counter;
+        for (size_t i = 0; i < CompactCounter<uint16_t>::kMax; ++i) {
+            counter.IncRef();
+        }
+        REQUIRE(counter.RefCount() == 65535);
+        REQUIRE(counter.IncRef() == 65535);
+        // Saturated counters never reach zero again.
+        REQUIRE(counter.DecRef() == 65535);
+
+        AtomicCompactCounter<uint16_t> atomic;
+        for (size_t i = 0; i < 65536; ++i) {
+            atomic.IncRef();
+        }
+        REQUIRE(atomic.RefCount() == 65535);
+        REQUIRE(atomic.DecRef() == 65535);
+    }
+}
+
+struct Observed : public RefCountedWithWeak<Observed> {
+    explicit Observed(std::string name) : name(std::move(name)) {
+        ++alive;
+    }
+
+    ~Observed() {
+        --alive;
+    }
+
+    std::string name;
+
+    static inline std::atomic<int> alive = 0;
+};
+
+TEST_CASE("Weak references") {
+    SECTION("Lock and expire") {
+        IntrusiveWeakPtr<Observed> weak;
+        REQUIRE(weak.Expired());
+        REQUIRE(!weak.Lock());
+        {
+            auto strong = MakeIntrusive<Observed>("abc");
+            weak = IntrusiveWeakPtr<Observed>(strong);
+            REQUIRE(!weak.Expired());
+            REQUIRE(weak.UseCount() == 1);
+
+            auto locked = weak.Lock();
+            REQUIRE(locked.Get() == strong.Get());
+            REQUIRE(strong.UseCount() == 2);
+        }
+        // Destroyed, but the memory (and the counts) are still there for `weak`.
+        REQUIRE(Observed::alive == 0);
+        REQUIRE(weak.Expired());
+        REQUIRE(!weak.Lock());
+
+        auto copy = weak;
+        weak.Reset();
+        REQUIRE(copy.Expired());
+    }
+
+    SECTION("Weak pointer dies first") {
+        auto strong = MakeIntrusive<Observed>("abc");
+        {
+            IntrusiveWeakPtr<Observed> weak(strong);
+            IntrusiveWeakPtr<Observed> moved(std::move(weak));
+            REQUIRE(moved.Lock()->name == "abc");
+        }
+        REQUIRE(strong.UseCount() == 1);
+    }
+
+    SECTION("Concurrent promotion") {
+        constexpr int kThreads = 4;
+        constexpr int kRounds = 1000;
+
+        std::atomic<int> corrupted = 0;
+        for (int round = 0; round < kRounds; ++round) {
+            auto strong = MakeIntrusive<Observed>("abc");
+            IntrusiveWeakPtr<Observed> weak(strong);
+            std::vector<std::thread> threads;
+            for (int i = 0; i < kThreads; ++i) {
+                threads.emplace_back([weak, &corrupted]() {
+                    if (auto locked = weak.Lock(); locked && locked->name != "abc") {
+                        ++corrupted;
+                    }
+                });
+            }
+            strong.Reset();
+            for (auto& thread : threads) {
+                thread.join();
+            }
+            REQUIRE(weak.Expired());
+        }
+        REQUIRE(corrupted == 0);
+        REQUIRE(Observed::alive == 0);
+    }
+}
+
 TEST_CASE("No copies") {
     IntrusivePtr<Pinned> p(new Pinned(1));
 }
@@ -0,0 +1,118 @@
+#include "atomic_intrusive.h"
+
+#include <catch.hpp>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+struct Version : public AtomicRefCounted<Version> {
+    explicit Version(int value) : value(value), check(~value) {
+        ++alive;
+    }
+
+    ~Version() {
+        check = 0;
+        --alive;
+    }
+
+    bool Intact() const {
+        return check == ~value;
+    }
+
+    int value;
+    int check;
+
+    static inline std::atomic<int> alive = 0;
+};
+
+using VersionPtr = IntrusivePtr<Version>;
+
+}  // namespace
+
+TEST_CASE("Atomic slot") {
+    Version::alive = 0;
+    {
+        AtomicIntrusivePtr<Version> slot;
+        REQUIRE(slot.IsNull());
+        REQUIRE(!slot.Load());
+
+        VersionPtr first = MakeIntrusive<Version>(1);
+        slot.Store(first);
+        REQUIRE(first.UseCount() == 2);
+        REQUIRE(slot.Load().Get() == first.Get());
+
+        VersionPtr old = slot.Exchange(MakeIntrusive<Version>(2));
+        REQUIRE(old.Get() == first.Get());
+        REQUIRE(first.UseCount() == 2);
+        old.Reset();
+        REQUIRE(first.UseCount() == 1);
+
+        SECTION("Compare exchange") {
+            VersionPtr expected = first;
+            REQUIRE(!slot.CompareExchange(expected, MakeIntrusive<Version>(3)));
+            REQUIRE(expected->value == 2);
+            REQUIRE(expected.UseCount() == 2);
+
+            VersionPtr third = MakeIntrusive<Version>(3);
+            REQUIRE(slot.CompareExchange(expected, third));
+            REQUIRE(expected.UseCount() == 1);
+            REQUIRE(third.UseCount() == 2);
+            REQUIRE(slot.Load()->value == 3);
+        }
+
+        SECTION("Clear") {
+            slot.Store(nullptr);
+            REQUIRE(slot.IsNull());
+            REQUIRE(Version::alive == 1);
+        }
+    }
+    REQUIRE(Version::alive == 0);
+}
+
+TEST_CASE("Atomic slot under contention") {
+    constexpr int kThreads = 4;
+    constexpr int kIncrements = 20'000;
+
+    Version::alive = 0;
+    {
+        AtomicIntrusivePtr<Version> slot(MakeIntrusive<Version>(0));
+        std::atomic<int> corrupted = 0;
+
+        std::vector<std::thread> threads;
+        // Writers bump the version with CAS; readers only load.
+        for (int i = 0; i < kThreads; ++i) {
+            threads.emplace_back([&] {
+                VersionPtr expected = slot.Load();
+                for (int j = 0; j < kIncrements; ++j) {
+                    while (!slot.CompareExchange(expected,
+                                                 MakeIntrusive<Version>(expected->value + 1))) {
+                    }
+                    expected = slot.Load();
+                }
+            });
+            threads.emplace_back([&] {
+                int last = 0;
+                for (int j = 0; j < kIncrements; ++j) {
+                    VersionPtr current = slot.Load();
+                    if (!current->Intact() || current->value < last) {
+                        ++corrupted;
+                    }
+                    last = current->value;
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        REQUIRE(corrupted == 0);
+        REQUIRE(slot.Load()->value == kThreads * kIncrements);
+        REQUIRE(Version::alive == 1);
+    }
+    REQUIRE(Version::alive == 0);
+}
@@ -0,0 +1,169 @@
+#include "hash_set.h"
+#include "list.h"
+
+#include <catch.hpp>
+
+#include "allocations_checker.h"
+
+#include <string>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+struct ByAge;
+struct ByOwner;
+
+// One object, three memberships, no extra nodes.
+struct Connection : public SimpleRefCounted<Connection>,
+                    public ListHook<ByAge>,
+                    public ListHook<ByOwner>,
+                    public HashSetHook<> {
+    explicit Connection(int id) : id(id) {
+        ++alive;
+    }
+
+    ~Connection() {
+        --alive;
+    }
+
+    int id;
+
+    static inline int alive = 0;
+};
+
+using AgeList = IntrusiveList<Connection, ByAge>;
+using OwnerList = IntrusiveList<Connection, ByOwner>;
+using ConnectionTable = IntrusiveHashSet<Connection, &Connection::id>;
+
+std::vector<int> Ids(const AgeList& list) {
+    std::vector<int> ids;
+    for (const Connection& connection : list) {
+        ids.push_back(connection.id);
+    }
+    return ids;
+}
+
+struct Named : public SimpleRefCounted<Named>, public HashSetHook<> {
+    explicit Named(std::string name) : name(std::move(name)) {
+    }
+
+    std::string name;
+};
+
+}  // namespace
+
+TEST_CASE("Intrusive list") {
+    Connection::alive = 0;
+    {
+        AgeList list;
+        REQUIRE(list.Empty());
+        REQUIRE(list.Front() == nullptr);
+        REQUIRE(!list.PopFront());
+
+        for (int i = 1; i <= 3; ++i) {
+            list.PushBack(MakeIntrusive<Connection>(i));
+        }
+        list.PushFront(MakeIntrusive<Connection>(0));
+        REQUIRE(list.Size() == 4);
+        REQUIRE(Ids(list) == std::vector<int>{0, 1, 2, 3});
+        REQUIRE(list.Front()->id == 0);
+        REQUIRE(list.Back()->id == 3);
+        // The list holds the only reference.
+        REQUIRE(list.Front()->RefCount() == 1);
+        REQUIRE(Connection::alive == 4);
+
+        Connection& second = *++list.begin();
+        EXPECT_ZERO_ALLOCATIONS(list.MoveToBack(second));
+        REQUIRE(Ids(list) == std::vector<int>{0, 2, 3, 1});
+
+        IntrusivePtr<Connection> erased = list.Erase(second);
+        REQUIRE(erased->id == 1);
+        REQUIRE(erased->RefCount() == 1);
+        REQUIRE(!erased->ListHook<ByAge>::IsLinked());
+
+        list.Insert(list.end(), erased);
+        REQUIRE(Ids(list) == std::vector<int>{0, 2, 3, 1});
+        erased.Reset();
+
+        REQUIRE(list.PopBack()->id == 1);
+        REQUIRE(Connection::alive == 3);
+        REQUIRE(list.PopFront()->id == 0);
+        REQUIRE(Ids(list) == std::vector<int>{2, 3});
+    }
+    REQUIRE(Connection::alive == 0);
+}
+
+TEST_CASE("Intrusive hash set") {
+    Connection::alive = 0;
+    {
+        ConnectionTable table;
+        REQUIRE(table.Find(1) == nullptr);
+
+        for (int i = 0; i < 100; ++i) {
+            REQUIRE(table.Insert(MakeIntrusive<Connection>(i)));
+        }
+        REQUIRE(table.Size() == 100);
+        REQUIRE(table.BucketCount() >= 100);
+        REQUIRE(!table.Insert(MakeIntrusive<Connection>(42)));
+        REQUIRE(Connection::alive == 100);
+
+        for (int i = 0; i < 100; ++i) {
+            REQUIRE(table.Find(i)->id == i);
+        }
+        REQUIRE(!table.Contains(100));
+
+        IntrusivePtr<Connection> erased = table.Erase(42);
+        REQUIRE(erased->id == 42);
+        REQUIRE(!erased->HashSetHook<>::IsLinked());
+        REQUIRE(!table.Contains(42));
+        REQUIRE(!table.Erase(42));
+
+        IntrusivePtr<Connection> seven = table.Erase(*table.Find(7));
+        REQUIRE(seven->id == 7);
+        REQUIRE(table.Size() == 98);
+
+        int sum = 0;
+        table.ForEach([&](const Connection& connection) { sum += connection.id; });
+        REQUIRE(sum == 99 * 100 / 2 - 42 - 7);
+
+        table.Clear();
+        REQUIRE(table.Empty());
+        REQUIRE(Connection::alive == 2);
+    }
+    REQUIRE(Connection::alive == 0);
+
+    IntrusiveHashSet<Named, [](const Named& named) -> const std::string& { return named.name; }>
+        names(16);
+    REQUIRE(names.BucketCount() == 16);
+    REQUIRE(names.Insert(MakeIntrusive<Named>("a")));
+    REQUIRE(names.Contains("a"));
+    REQUIRE(!names.Contains("b"));
+}
+
+TEST_CASE("Several memberships") {
+    Connection::alive = 0;
+    {
+        AgeList by_age;
+        OwnerList by_owner;
+        ConnectionTable table;
+
+        auto connection = MakeIntrusive<Connection>(5);
+        Connection* raw = connection.Get();
+        EXPECT_ZERO_ALLOCATIONS(by_age.PushBack(connection));
+        EXPECT_ZERO_ALLOCATIONS(by_owner.PushBack(connection));
+        table.Insert(std::move(connection));
+        REQUIRE(raw->RefCount() == 3);
+
+        // Leaving one container keeps the object alive for the others.
+        by_owner.Erase(*raw);
+        REQUIRE(raw->RefCount() == 2);
+        table.Erase(5);
+        REQUIRE(Connection::alive == 1);
+        REQUIRE(by_age.Front() == raw);
+        REQUIRE(raw->ListHook<ByAge>::IsLinked());
+        REQUIRE(!raw->ListHook<ByOwner>::IsLinked());
+    }
+    REQUIRE(Connection::alive == 0);
+}
@@ -0,0 +1,111 @@
+#include "cow.h"
+
+#include <catch.hpp>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+struct Config {
+    explicit Config(std::string name) : name(std::move(name)) {
+    }
+
+    Config(const Config& other) : name(other.name), limits(other.limits) {
+        ++copies;
+    }
+
+    std::string name;
+    std::vector<int> limits = {1, 2, 3};
+
+    static inline std::atomic<int> copies = 0;
+};
+
+}  // namespace
+
+TEST_CASE("Copy on write") {
+    Config::copies = 0;
+
+    CowPtr<Config> empty;
+    REQUIRE(!empty);
+    REQUIRE(empty.Get() == nullptr);
+    REQUIRE(empty.UseCount() == 0);
+
+    auto a = MakeCow<Config>("prod");
+    REQUIRE(a->name == "prod");
+    REQUIRE(a.UseCount() == 1);
+
+    SECTION("Unique owner writes in place") {
+        const Config* before = a.Get();
+        a.Mutate().name = "staging";
+        REQUIRE(a.Get() == before);
+        REQUIRE(Config::copies == 0);
+    }
+
+    SECTION("Readers share") {
+        CowPtr<Config> b = a;
+        CowPtr<Config> c = b;
+        REQUIRE(a.UseCount() == 3);
+        REQUIRE(&*b == &*a);
+        REQUIRE((*c).limits.size() == 3);
+        REQUIRE(Config::copies == 0);
+    }
+
+    SECTION("Shared owner clones") {
+        CowPtr<Config> b = a;
+        b.Mutate().limits.push_back(4);
+        REQUIRE(Config::copies == 1);
+        REQUIRE(a->limits.size() == 3);
+        REQUIRE(b->limits.size() == 4);
+        REQUIRE(a.UseCount() == 1);
+        REQUIRE(b.UseCount() == 1);
+
+        // Now unique: no more copies.
+        b.Mutate().limits.push_back(5);
+        REQUIRE(Config::copies == 1);
+
+        a.Swap(b);
+        REQUIRE(a->limits.size() == 5);
+        b.Reset();
+        REQUIRE(!b);
+    }
+}
+
+TEST_CASE("Atomic copy on write") {
+    constexpr int kThreads = 4;
+    constexpr int kIterations = 10'000;
+
+    Config::copies = 0;
+    auto shared = MakeAtomicCow<Config>("shared");
+    std::atomic<int> corrupted = 0;
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < kThreads; ++i) {
+        threads.emplace_back([&corrupted, copy = shared, i]() mutable {
+            for (int j = 0; j < kIterations; ++j) {
+                AtomicCowPtr<Config> local = copy;
+                if (local->limits.size() != 3) {
+                    ++corrupted;
+                }
+                // Every write lands in a private clone.
+                local.Mutate().limits.push_back(i);
+                if (local->limits.size() != 4 || copy->limits.size() != 3) {
+                    ++corrupted;
+                }
+            }
+            // Still shared with `shared`, so this clones too.
+            copy.Mutate().name = "mine";
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    REQUIRE(corrupted == 0);
+    REQUIRE(shared->name == "shared");
+    REQUIRE(shared.UseCount() == 1);
+}
@@ -0,0 +1,184 @@
+#include "object_pool.h"
+
+#include <catch.hpp>
+
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+struct Message : public AtomicRefCounted<Message, PooledDelete> {
+    explicit Message(std::string text) : text(std::move(text)) {
+        if (this->text.empty()) {
+            throw std::invalid_argument("empty message");
+        }
+        ++alive;
+    }
+
+    ~Message() {
+        --alive;
+    }
+
+    std::string text;
+
+    static inline std::atomic<int> alive = 0;
+};
+
+struct Reserved : public SimpleRefCounted<Reserved, PooledDelete> {
+    int value = 0;
+};
+
+struct Bounded : public SimpleRefCounted<Bounded, PooledDelete> {
+    int value = 0;
+};
+
+struct Exiting : public SimpleRefCounted<Exiting, PooledDelete> {
+    int value = 0;
+};
+
+// Drop `objects` on a short-lived thread, so they end up in its magazine when it exits.
+void FreeOnThread(std::vector<IntrusivePtr<Exiting>>& objects) {
+    std::thread([&objects] { objects.clear(); }).join();
+}
+
+struct Shared : public AtomicRefCounted<Shared, PooledDelete> {
+    explicit Shared(int value) : value(value) {
+    }
+
+    int value;
+};
+
+}  // namespace
+
+TEST_CASE("Intrusive object pool") {
+    auto& pool = IntrusiveObjectPool<Message>::Instance();
+
+    SECTION("Recycling") {
+        Message* address = nullptr;
+        {
+            auto message = pool.Make("first");
+            address = message.Get();
+            REQUIRE(Message::alive == 1);
+        }
+        REQUIRE(Message::alive == 0);
+
+        auto before = pool.GetStats();
+        auto message = pool.Make("second");
+        auto after = pool.GetStats();
+        REQUIRE(message.Get() == address);
+        REQUIRE(message->text == "second");
+        REQUIRE(after.hits == before.hits + 1);
+        REQUIRE(after.misses == before.misses);
+    }
+
+    SECTION("Failed construction") {
+        auto before = pool.GetStats();
+        REQUIRE_THROWS_AS(pool.Make(""), std::invalid_argument);
+        auto message = pool.Make("ok");
+        REQUIRE(pool.GetStats().misses <= before.misses + 1);
+        REQUIRE(Message::alive == 1);
+    }
+
+    SECTION("Plain new is recycled too") {
+        IntrusivePtr<Message> message(new Message("heap"));
+        Message* address = message.Get();
+        message.Reset();
+        REQUIRE(pool.Make("pooled").Get() == address);
+    }
+}
+
+TEST_CASE("Intrusive object pool reserve") {
+    auto& pool = IntrusiveObjectPool<Reserved>::Instance();
+    pool.Reserve(100);
+    REQUIRE(pool.Retained() == 100);
+
+    std::vector<IntrusivePtr<Reserved>> objects;
+    for (int i = 0; i < 100; ++i) {
+        objects.push_back(pool.Make());
+    }
+    auto stats = pool.GetStats();
+    REQUIRE(stats.hits == 100);
+    REQUIRE(stats.misses == 0);
+    REQUIRE(pool.Retained() == 0);
+}
+
+TEST_CASE("Intrusive object pool capacity") {
+    auto& pool = IntrusiveObjectPool<Bounded>::Instance();
+    pool.SetCapacity(0);
+    {
+        std::vector<IntrusivePtr<Bounded>> objects;
+        for (int i = 0; i < 1000; ++i) {
+            objects.push_back(pool.Make());
+        }
+    }
+    REQUIRE(pool.Retained() == 0);
+}
+
+TEST_CASE("Intrusive object pool thread exit") {
+    constexpr int kObjects = 10;
+
+    auto& pool = IntrusiveObjectPool<Exiting>::Instance();
+    std::vector<IntrusivePtr<Exiting>> objects;
+    for (int i = 0; i < kObjects; ++i) {
+        objects.push_back(pool.Make());
+    }
+    FreeOnThread(objects);
+    REQUIRE(pool.Retained() == kObjects);
+
+    for (int i = 0; i < kObjects; ++i) {
+        objects.push_back(pool.Make());
+    }
+    REQUIRE(pool.Retained() == 0);
+
+    // The exit path respects the capacity as well.
+    pool.SetCapacity(kObjects / 2);
+    FreeOnThread(objects);
+    REQUIRE(pool.Retained() == 0);
+    pool.SetCapacity(SIZE_MAX);
+}
+
+TEST_CASE("Intrusive object pool threads") {
+    constexpr int kThreads = 4;
+    constexpr int kRounds = 50;
+    constexpr int kObjects = 500;
+
+    auto& pool = IntrusiveObjectPool<Shared>::Instance();
+    std::atomic<int> corrupted = 0;
+
+    // Every thread frees the objects made by its neighbour in the previous round, so storage keeps
+    // moving between thread caches.
+    std::vector<std::vector<IntrusivePtr<Shared>>> current(kThreads);
+    std::vector<std::vector<IntrusivePtr<Shared>>> next(kThreads);
+    for (int round = 0; round < kRounds; ++round) {
+        std::vector<std::thread> threads;
+        for (int i = 0; i < kThreads; ++i) {
+            threads.emplace_back([&, i]() {
+                current[i].clear();
+                std::vector<IntrusivePtr<Shared>> made;
+                for (int j = 0; j < kObjects; ++j) {
+                    made.push_back(pool.Make(j));
+                }
+                for (int j = 0; j < kObjects; ++j) {
+                    if (made[j]->value != j) {
+                        ++corrupted;
+                    }
+                }
+                next[(i + 1) % kThreads] = std::move(made);
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        std::swap(current, next);
+    }
+    current.clear();
+    REQUIRE(corrupted == 0);
+    auto stats = pool.GetStats();
+    REQUIRE(stats.hits + stats.misses == kThreads * kRounds * kObjects);
+    REQUIRE(stats.hits > stats.misses);
+}
@@ -0,0 +1,442 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>  // for std::nullptr_t
+#include <type_traits>
+#include <utility>  // for std::exchange / std::swap
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Counter policies
+//
+// A counter starts at zero; `IncRef()`/`DecRef()` return the new value. Copying an object that
+// embeds a counter must not copy the count, so copies start from zero and assignment is a no-op.
+
+// Exclusive ownership: nothing to count, the pointer is move-only.
+class NoRefCount {
+public:
+    static constexpr bool kShared = false;
+};
+
+// Single-threaded counting.
+class PlainRefCount {
+public:
+    static constexpr bool kShared = true;
+
+    PlainRefCount() = default;
+
+    PlainRefCount(const PlainRefCount&) {
+    }
+
+    PlainRefCount& operator=(const PlainRefCount&) {
+        return *this;
+    }
+
+    size_t IncRef() {
+        return ++count_;
+    }
+
+    size_t DecRef() {
+        return --count_;
+    }
+
+    size_t RefCount() const {
+        return count_;
+    }
+
+private:
+    size_t count_ = 0;
+};
+
+// Thread-safe counting: relaxed increments, release decrements, acquire before destruction.
+class AtomicRefCount {
+public:
+    static constexpr bool kShared = true;
+
+    AtomicRefCount() = default;
+
+    AtomicRefCount(const AtomicRefCount&) {
+    }
+
+    AtomicRefCount& operator=(const AtomicRefCount&) {
+        return *this;
+    }
+
+    size_t IncRef() {
+        return count_.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+
+    size_t DecRef() {
+        size_t count = count_.fetch_sub(1, std::memory_order_release) - 1;
+        if (count == 0) {
+            std::atomic_thread_fence(std::memory_order_acquire);
+        }
+        return count;
+    }
+
+    size_t RefCount() const {
+        return count_.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<size_t> count_ = 0;
+};
+
+// Thread-safe counting biased towards the uniquely owned case. A holder that observes a count of
+// one is the only holder, and nobody can gain a new reference without it, so the last release is a
+// plain acquire load instead of a locked read-modify-write.
+class BiasedRefCount {
+public:
+    static constexpr bool kShared = true;
+
+    BiasedRefCount() = default;
+
+    BiasedRefCount(const BiasedRefCount&) {
+    }
+
+    BiasedRefCount& operator=(const BiasedRefCount&) {
+        return *this;
+    }
+
+    size_t IncRef() {
+        return count_.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+
+    size_t DecRef() {
+        if (count_.load(std::memory_order_acquire) == 1) {
+            return 0;
+        }
+        return count_.fetch_sub(1, std::memory_order_acq_rel) - 1;
+    }
+
+    size_t RefCount() const {
+        return count_.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<size_t> count_ = 0;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Deleter policies: a type with `static void Destroy(T*)`.
+
+struct HeapDelete {
+    template <typename T>
+    static void Destroy(T* object) {
+        delete object;
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Storage policies
+//
+// A storage policy is the state of the pointer. It knows where the counter lives and exposes
+// `GetObject()`, `Acquire()` (one more reference), `Dispose()` (drop the reference held by this
+// state, destroying the object if it was the last one), `Forget()` (become null without touching
+// the counter), `Count()` and a static `Create(args...)`. Null states must be safe to `Dispose()`.
+
+// Counter in a small block allocated next to a user-allocated object, like `SharedPtr(T*)`.
+template <typename T, typename Counter, typename Deleter>
+class ExternalStorage {
+private:
+    struct Block {
+        Counter counter;
+    };
+
+    T* object_ = nullptr;
+    Block* block_ = nullptr;
+
+protected:
+    ExternalStorage() = default;
+
+    explicit ExternalStorage(T* object) : object_(object) {
+        if (object_ != nullptr) {
+            block_ = new Block;
+            block_->counter.IncRef();
+        }
+    }
+
+    template <typename... Args>
+    static ExternalStorage Create(Args&&... args) {
+        static_assert(std::is_same_v<Deleter, HeapDelete>, "Create() allocates with `new`");
+        return ExternalStorage(new T(std::forward<Args>(args)...));
+    }
+
+    T* GetObject() const {
+        return object_;
+    }
+
+    void Acquire() {
+        if (block_ != nullptr) {
+            block_->counter.IncRef();
+        }
+    }
+
+    void Dispose() {
+        if (block_ != nullptr && block_->counter.DecRef() == 0) {
+            Deleter::Destroy(object_);
+            delete block_;
+        }
+    }
+
+    void Forget() {
+        object_ = nullptr;
+        block_ = nullptr;
+    }
+
+    size_t Count() const {
+        return block_ != nullptr ? block_->counter.RefCount() : 0;
+    }
+};
+
+// Exclusive ownership needs no block at all: this is `UniquePtr<T>`.
+template <typename T, typename Deleter>
+class ExternalStorage<T, NoRefCount, Deleter> {
+private:
+    T* object_ = nullptr;
+
+protected:
+    ExternalStorage() = default;
+
+    explicit ExternalStorage(T* object) : object_(object) {
+    }
+
+    template <typename... Args>
+    static ExternalStorage Create(Args&&... args) {
+        static_assert(std::is_same_v<Deleter, HeapDelete>, "Create() allocates with `new`");
+        return ExternalStorage(new T(std::forward<Args>(args)...));
+    }
+
+    T* GetObject() const {
+        return object_;
+    }
+
+    void Dispose() {
+        if (object_ != nullptr) {
+            Deleter::Destroy(object_);
+        }
+    }
+
+    void Forget() {
+        object_ = nullptr;
+    }
+};
+
+// Counter and object in one allocation, like `MakeShared`. Only `Create()` makes non-null states,
+// and the block is always allocated with `new`, so the deleter must be `HeapDelete`.
+template <typename T, typename Counter, typename Deleter>
+class InlineStorage {
+    static_assert(std::is_same_v<Deleter, HeapDelete>, "InlineStorage owns its allocation");
+    static_assert(Counter::kShared, "Use ExternalStorage for exclusive ownership");
+
+private:
+    struct Block {
+        template <typename... Args>
+        Block(Args&&... args) : value(std::forward<Args>(args)...) {
+        }
+
+        Counter counter;
+        T value;
+    };
+
+    Block* block_ = nullptr;
+
+protected:
+    InlineStorage() = default;
+
+    template <typename... Args>
+    static InlineStorage Create(Args&&... args) {
+        InlineStorage storage;
+        storage.block_ = new Block(std::forward<Args>(args)...);
+        storage.block_->counter.IncRef();
+        return storage;
+    }
+
+    T* GetObject() const {
+        return block_ != nullptr ? &block_->value : nullptr;
+    }
+
+    void Acquire() {
+        if (block_ != nullptr) {
+            block_->counter.IncRef();
+        }
+    }
+
+    void Dispose() {
+        if (block_ != nullptr && block_->counter.DecRef() == 0) {
+            delete block_;
+        }
+    }
+
+    void Forget() {
+        block_ = nullptr;
+    }
+
+    size_t Count() const {
+        return block_ != nullptr ? block_->counter.RefCount() : 0;
+    }
+};
+
+// Mixin that puts the counter into the object itself, for `IntrusiveStorage`.
+template <typename Counter>
+class PolicyRefCounted {
+public:
+    Counter& RefCounter() const {
+        return counter_;
+    }
+
+private:
+    mutable Counter counter_;
+};
+
+// Counter inside the object, like `IntrusivePtr`: a raw pointer can always be wrapped again.
+template <typename T, typename Counter, typename Deleter>
+class IntrusiveStorage {
+    static_assert(Counter::kShared, "Use ExternalStorage for exclusive ownership");
+
+private:
+    T* object_ = nullptr;
+
+protected:
+    IntrusiveStorage() = default;
+
+    explicit IntrusiveStorage(T* object) : object_(object) {
+        Acquire();
+    }
+
+    template <typename... Args>
+    static IntrusiveStorage Create(Args&&... args) {
+        static_assert(std::is_same_v<Deleter, HeapDelete>, "Create() allocates with `new`");
+        return IntrusiveStorage(new T(std::forward<Args>(args)...));
+    }
+
+    T* GetObject() const {
+        return object_;
+    }
+
+    void Acquire() {
+        if (object_ != nullptr) {
+            object_->RefCounter().IncRef();
+        }
+    }
+
+    void Dispose() {
+        if (object_ != nullptr && object_->RefCounter().DecRef() == 0) {
+            Deleter::Destroy(object_);
+        }
+    }
+
+    void Forget() {
+        object_ = nullptr;
+    }
+
+    size_t Count() const {
+        return object_ != nullptr ? object_->RefCounter().RefCount() : 0;
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// The pointer itself: move, copy, swap and reset written once for every combination of policies.
+// Policies are resolved at compile time, so e.g. `PolicyPtr<Node, PlainRefCount, IntrusiveStorage>`
+// is exactly a non-atomic intrusive pointer, and a custom `Deleter` costs no more than a call.
+
+template <typename T, typename Counter, template <typename, typename, typename> class Storage,
+          typename Deleter = HeapDelete>
+class PolicyPtr : private Storage<T, Counter, Deleter> {
+private:
+    using Base = Storage<T, Counter, Deleter>;
+
+    explicit PolicyPtr(Base&& storage) noexcept : Base(std::move(storage)) {
+    }
+
+public:
+    // Relocating a handle is a plain byte copy (see `IsTriviallyRelocatable`).
+    using TriviallyRelocatable = std::true_type;
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Constructors
+
+    PolicyPtr() = default;
+
+    PolicyPtr(std::nullptr_t) {
+    }
+
+    explicit PolicyPtr(T* object) : Base(object) {
+    }
+
+    PolicyPtr(const PolicyPtr& other) requires Counter::kShared : Base(other) {
+        Base::Acquire();
+    }
+
+    PolicyPtr(PolicyPtr&& other) noexcept : Base(other) {
+        other.Forget();
+    }
+
+    template <typename... Args>
+    static PolicyPtr Make(Args&&... args) {
+        return PolicyPtr(Base::Create(std::forward<Args>(args)...));
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // `operator=`-s
+
+    PolicyPtr& operator=(const PolicyPtr& other) requires Counter::kShared {
+        PolicyPtr(other).Swap(*this);
+        return *this;
+    }
+
+    PolicyPtr& operator=(PolicyPtr&& other) noexcept {
+        PolicyPtr(std::move(other)).Swap(*this);
+        return *this;
+    }
+
+    PolicyPtr& operator=(std::nullptr_t) {
+        Reset();
+        return *this;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Destructor
+
+    ~PolicyPtr() {
+        Base::Dispose();
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Modifiers
+
+    void Reset() {
+        Base::Dispose();
+        Base::Forget();
+    }
+
+    void Reset(T* object) {
+        PolicyPtr(object).Swap(*this);
+    }
+
+    void Swap(PolicyPtr& other) noexcept {
+        std::swap(static_cast<Base&>(*this), static_cast<Base&>(other));
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Observers
+
+    T* Get() const {
+        return Base::GetObject();
+    }
+
+    T& operator*() const {
+        return *Get();
+    }
+
+    T* operator->() const {
+        return Get();
+    }
+
+    size_t UseCount() const requires Counter::kShared {
+        return Base::Count();
+    }
+
+    explicit operator bool() const {
+        return Get() != nullptr;
+    }
+};
@@ -0,0 +1,191 @@
+#include "policy.h"
+
+#include <catch.hpp>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+struct Counted {
+    Counted() {
+        ++alive;
+    }
+
+    Counted(int value) : value(value) {
+        ++alive;
+    }
+
+    Counted(const Counted& other) : value(other.value) {
+        ++alive;
+    }
+
+    ~Counted() {
+        --alive;
+    }
+
+    int value = 0;
+
+    static inline int alive = 0;
+};
+
+template <typename Counter>
+struct IntrusiveCounted : Counted, PolicyRefCounted<Counter> {
+    using Counted::Counted;
+};
+
+// Objects are "allocated" from a fixed buffer; destruction only runs the destructor.
+struct ArenaDelete {
+    template <typename T>
+    static void Destroy(T* object) {
+        object->~T();
+        ++destroyed;
+    }
+
+    static inline int destroyed = 0;
+};
+
+struct AtomicDestroyed {
+    ~AtomicDestroyed() {
+        ++destroyed;
+    }
+
+    static inline std::atomic<int> destroyed = 0;
+};
+
+template <typename T>
+using UniqueHandle = PolicyPtr<T, NoRefCount, ExternalStorage>;
+
+template <typename T, typename Counter>
+using SharedHandle = PolicyPtr<T, Counter, InlineStorage>;
+
+template <typename T, typename Counter>
+using ExternalHandle = PolicyPtr<T, Counter, ExternalStorage>;
+
+template <typename T, typename Counter>
+using IntrusiveHandle = PolicyPtr<T, Counter, IntrusiveStorage>;
+
+}  // namespace
+
+TEST_CASE("Policy layout") {
+    static_assert(sizeof(UniqueHandle<int>) == sizeof(void*));
+    static_assert(sizeof(SharedHandle<int, AtomicRefCount>) == sizeof(void*));
+    static_assert(sizeof(ExternalHandle<int, PlainRefCount>) == 2 * sizeof(void*));
+    static_assert(sizeof(IntrusiveHandle<IntrusiveCounted<PlainRefCount>, PlainRefCount>) ==
+                  sizeof(void*));
+
+    static_assert(!std::is_copy_constructible_v<UniqueHandle<int>>);
+    static_assert(!std::is_copy_assignable_v<UniqueHandle<int>>);
+    static_assert(std::is_nothrow_move_constructible_v<UniqueHandle<int>>);
+    static_assert(std::is_copy_constructible_v<SharedHandle<int, PlainRefCount>>);
+    static_assert(std::is_nothrow_move_assignable_v<SharedHandle<int, BiasedRefCount>>);
+}
+
+TEST_CASE("Unique policy") {
+    {
+        auto a = UniqueHandle<Counted>::Make(1);
+        UniqueHandle<Counted> b(new Counted(2));
+        REQUIRE(Counted::alive == 2);
+
+        a = std::move(b);
+        REQUIRE(Counted::alive == 1);
+        REQUIRE(a->value == 2);
+        REQUIRE(!b);
+
+        a.Swap(b);
+        REQUIRE(b->value == 2);
+        b.Reset(new Counted(3));
+        REQUIRE(b->value == 3);
+        REQUIRE(Counted::alive == 1);
+    }
+    REQUIRE(Counted::alive == 0);
+}
+
+TEMPLATE_TEST_CASE("Shared policies", "", PlainRefCount, AtomicRefCount, BiasedRefCount) {
+    SECTION("Inline") {
+        {
+            auto a = SharedHandle<Counted, TestType>::Make(42);
+            auto b = a;
+            SharedHandle<Counted, TestType> c;
+            c = b;
+            REQUIRE(a.UseCount() == 3);
+            REQUIRE(c->value == 42);
+            b.Reset();
+            c = std::move(a);
+            REQUIRE(c.UseCount() == 1);
+            REQUIRE(Counted::alive == 1);
+        }
+        REQUIRE(Counted::alive == 0);
+    }
+
+    SECTION("External") {
+        {
+            ExternalHandle<Counted, TestType> a(new Counted(1));
+            auto b = a;
+            REQUIRE(b.UseCount() == 2);
+            a.Reset(new Counted(2));
+            REQUIRE(Counted::alive == 2);
+            REQUIRE(b.UseCount() == 1);
+        }
+        REQUIRE(Counted::alive == 0);
+    }
+
+    SECTION("Intrusive") {
+        using Object = IntrusiveCounted<TestType>;
+        {
+            auto a = IntrusiveHandle<Object, TestType>::Make(7);
+            IntrusiveHandle<Object, TestType> b(a.Get());
+            REQUIRE(a.UseCount() == 2);
+
+            // Copying the object must not copy its counter.
+            auto c = IntrusiveHandle<Object, TestType>::Make(*a);
+            REQUIRE(c.UseCount() == 1);
+            REQUIRE(c->value == 7);
+        }
+        REQUIRE(Counted::alive == 0);
+    }
+}
+
+TEST_CASE("Intrusive policy with arena deletion") {
+    using Object = IntrusiveCounted<PlainRefCount>;
+    using Ptr = PolicyPtr<Object, PlainRefCount, IntrusiveStorage, ArenaDelete>;
+
+    alignas(Object) unsigned char arena[2 * sizeof(Object)];
+    {
+        Ptr a(new (arena) Object(1));
+        Ptr b(new (arena + sizeof(Object)) Object(2));
+        Ptr c = a;
+        b = c;
+        REQUIRE(ArenaDelete::destroyed == 1);
+        REQUIRE(a.UseCount() == 3);
+    }
+    REQUIRE(ArenaDelete::destroyed == 2);
+    REQUIRE(Counted::alive == 0);
+}
+
+TEMPLATE_TEST_CASE("Concurrent policies", "", AtomicRefCount, BiasedRefCount) {
+    constexpr int kThreads = 4;
+    constexpr int kIterations = 100'000;
+
+    using Object = AtomicDestroyed;
+    Object::destroyed = 0;
+
+    {
+        auto root = SharedHandle<Object, TestType>::Make();
+        std::vector<std::thread> threads;
+        for (int i = 0; i < kThreads; ++i) {
+            threads.emplace_back([copy = root]() {
+                for (int j = 0; j < kIterations; ++j) {
+                    auto local = copy;
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+    REQUIRE(Object::destroyed == 1);
+}
@@ -3,6 +3,7 @@
 #include "sw_fwd.h"  // Forward declaration
 
 #include <cstddef>  // std::nullptr_t
+#include <type_traits>  // std::true_type
 
 class ControlBlockBase {
 public:
@@ -114,6 +115,9 @@ public:
     template <typename S>
     friend class SharedPtr;
 
+    // Relocating a handle is a plain byte copy (see `IsTriviallyRelocatable`).
+    using TriviallyRelocatable = std::true_type;
+
     ////////////////////////////////////////////////////////////////////////////////////////////////
     // Constructors
 
@@ -133,7 +137,7 @@ public:
         IncreaseCounter();
     }
 
-    SharedPtr(SharedPtr<T>&& other)
+    SharedPtr(SharedPtr<T>&& other) noexcept
         : block_(std::forward<ControlBlockBase*>(other.block_)),
           observed_(std::forward<T*>(other.observed_)) {
         other.block_ = nullptr;
@@ -165,7 +169,7 @@ public:
         return *this;
     }
 
-    SharedPtr& operator=(SharedPtr<T>&& other) {
+    SharedPtr& operator=(SharedPtr<T>&& other) noexcept {
         if (observed_ == other.observed_) {
             return *this;
         }
@@ -191,7 +195,7 @@ public:
     }
 
     template <typename S>
-    SharedPtr(SharedPtr<S>&& other)
+    SharedPtr(SharedPtr<S>&& other) noexcept
         : block_(std::forward<ControlBlockBase*>(other.block_)),
           observed_(std::forward<T*>(reinterpret_cast<T*>(other.observed_))) {
         other.block_ = nullptr;
@@ -214,7 +218,7 @@ public:
     }
 
     template <typename S>
-    SharedPtr& operator=(SharedPtr<S>&& other) {
+    SharedPtr& operator=(SharedPtr<S>&& other) noexcept {
         if (observed_ == other.observed_) {
             return *this;
         }
@@ -267,7 +271,7 @@ public:
         }
     }
 
-    void Swap(SharedPtr& other) {
+    void Swap(SharedPtr& other) noexcept {
         std::swap(block_, other.block_);
         std::swap(observed_, other.observed_);
     }
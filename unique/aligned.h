@@ -0,0 +1,67 @@
+#pragma once
+
+#include "unique.h"
+
+#include <cstddef>
+#include <memory>  // std::uninitialized_value_construct_n, std::destroy_n
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+
+template <typename T>
+class AlignedDeleter;
+
+// Deleter for arrays from `MakeUniqueAligned`. It remembers the length (so `UniquePtr<T[]>` gets
+// `Size()` and `Span()`) and the alignment that the memory has to be freed with.
+// `Reset(p)` keeps the deleter, so it may only be given a buffer of the same length and alignment.
+template <typename T>
+class AlignedDeleter<T[]> {
+public:
+    AlignedDeleter() = default;
+
+    AlignedDeleter(size_t size, size_t alignment) : size_(size), alignment_(alignment) {
+    }
+
+    void operator()(T* p) const {
+        std::destroy_n(p, size_);
+        ::operator delete(p, std::align_val_t(alignment_));
+    }
+
+    size_t Size() const {
+        return size_;
+    }
+
+    size_t Alignment() const {
+        return alignment_;
+    }
+
+private:
+    size_t size_ = 0;
+    size_t alignment_ = alignof(T);
+};
+
+template <typename T>
+using AlignedArray = UniquePtr<T, AlignedDeleter<T>>;
+
+inline constexpr size_t kCacheLineAlignment = 64;
+inline constexpr size_t kPageAlignment = 4096;
+
+// `n` value-initialized elements at an address that is a multiple of `alignment` (a power of two,
+// at least `alignof(T)`), e.g. `MakeUniqueAligned<float[]>(n, kCacheLineAlignment)`.
+template <typename T>
+    requires std::is_unbounded_array_v<T>
+AlignedArray<T> MakeUniqueAligned(size_t n, size_t alignment = kCacheLineAlignment) {
+    using Element = std::remove_extent_t<T>;
+    if ((alignment & (alignment - 1)) != 0 || alignment < alignof(Element)) {
+        throw std::invalid_argument("MakeUniqueAligned: bad alignment");
+    }
+    auto* data = static_cast<Element*>(
+        ::operator new(n * sizeof(Element), std::align_val_t(alignment)));
+    try {
+        std::uninitialized_value_construct_n(data, n);
+    } catch (...) {
+        ::operator delete(data, std::align_val_t(alignment));
+        throw;
+    }
+    return AlignedArray<T>(data, AlignedDeleter<T>(n, alignment));
+}
@@ -0,0 +1,154 @@
+#pragma once
+
+#include "unique.h"
+
+#include <algorithm>  // std::max
+#include <cstddef>  // std::max_align_t
+#include <cstdint>  // uintptr_t
+#include <new>
+#include <type_traits>
+#include <utility>  // std::forward, std::exchange
+
+// Bump allocator: allocation moves a pointer inside the current chunk, nothing is freed until
+// `Reset()` or destruction, which release everything at once. Chunks grow geometrically (and at
+// least to the size of the request). After `Reset()` the largest chunk is kept and reused, so a
+// steady per-request workload settles at zero heap allocations.
+//
+// Not thread-safe: use one arena per request/thread.
+class MonotonicArena {
+private:
+    struct Chunk {
+        Chunk* next;
+        size_t size;  // Usable bytes after the header
+    };
+
+    static constexpr size_t kHeader = (sizeof(Chunk) + alignof(std::max_align_t) - 1) &
+                                      ~(alignof(std::max_align_t) - 1);
+
+    Chunk* chunks_ = nullptr;
+    unsigned char* cursor_ = nullptr;
+    unsigned char* end_ = nullptr;
+    size_t next_chunk_size_;
+
+public:
+    static constexpr size_t kDefaultChunkSize = 4096;
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Constructors
+
+    // A zero size is taken as one byte, so that doubling in `Grow()` still makes progress.
+    explicit MonotonicArena(size_t initial_chunk_size = kDefaultChunkSize)
+        : next_chunk_size_(std::max<size_t>(initial_chunk_size, 1)) {
+    }
+
+    MonotonicArena(const MonotonicArena&) = delete;
+    MonotonicArena& operator=(const MonotonicArena&) = delete;
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Destructor
+
+    ~MonotonicArena() {
+        FreeChunks(chunks_);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Modifiers
+
+    void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t)) {
+        if (cursor_ != nullptr) {
+            unsigned char* result = AlignUp(cursor_, alignment);
+            if (result <= end_ && static_cast<size_t>(end_ - result) >= size) {
+                cursor_ = result + size;
+                return result;
+            }
+        }
+        Grow(size + alignment);
+        unsigned char* result = AlignUp(cursor_, alignment);
+        cursor_ = result + size;
+        return result;
+    }
+
+    // Construct a `T` in the arena. Nothing ever calls its destructor; see `MakeArenaUnique`.
+    template <typename T, typename... Args>
+    T* New(Args&&... args) {
+        return new (Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    // Release every allocation at once. Objects still alive in the arena must not be touched (nor
+    // destroyed) afterwards.
+    void Reset() {
+        if (chunks_ == nullptr) {
+            return;
+        }
+        // Keep the newest chunk, which is also the largest one, for the next round.
+        FreeChunks(std::exchange(chunks_->next, nullptr));
+        cursor_ = Begin(chunks_);
+        end_ = cursor_ + chunks_->size;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Observers
+
+    // Bytes still available in the current chunk.
+    size_t Available() const {
+        return static_cast<size_t>(end_ - cursor_);
+    }
+
+private:
+    static unsigned char* Begin(Chunk* chunk) {
+        return reinterpret_cast<unsigned char*>(chunk) + kHeader;
+    }
+
+    static unsigned char* AlignUp(unsigned char* ptr, size_t alignment) {
+        auto value = reinterpret_cast<uintptr_t>(ptr);
+        return ptr + ((alignment - value % alignment) % alignment);
+    }
+
+    void Grow(size_t at_least) {
+        size_t size = next_chunk_size_;
+        while (size < at_least) {
+            size *= 2;
+        }
+        auto* chunk = static_cast<Chunk*>(::operator new(kHeader + size));
+        chunk->next = chunks_;
+        chunk->size = size;
+        chunks_ = chunk;
+        cursor_ = Begin(chunk);
+        end_ = cursor_ + size;
+        next_chunk_size_ = size * 2;
+    }
+
+    static void FreeChunks(Chunk* chunk) {
+        while (chunk != nullptr) {
+            ::operator delete(std::exchange(chunk, chunk->next));
+        }
+    }
+};
+
+// Stateless deleter for objects living in a `MonotonicArena`: it only runs the destructor (and
+// nothing at all for trivially destructible types); the memory goes back with the arena. Being
+// empty, it keeps `UniquePtr<T, ArenaDeleter<T>>` at the size of a raw pointer.
+template <typename T>
+class ArenaDeleter {
+public:
+    ArenaDeleter() = default;
+
+    template <typename S>
+    ArenaDeleter(const ArenaDeleter<S>&) {
+    }
+
+    void operator()(T* p) const {
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            p->~T();
+        }
+    }
+};
+
+template <typename T>
+using ArenaPtr = UniquePtr<T, ArenaDeleter<T>>;
+
+// The pointer must not outlive (or survive a `Reset()` of) the arena.
+template <typename T, typename... Args>
+ArenaPtr<T> MakeArenaUnique(MonotonicArena& arena, Args&&... args) {
+    return ArenaPtr<T>(arena.New<T>(std::forward<Args>(args)...));
+}
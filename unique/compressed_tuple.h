@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>  // std::index_sequence, std::forward
+
+// N-ary `CompressedPair`: every empty, non-final member is stored as a base class and takes no
+// space, so e.g. a pointer with a stateless deleter, allocator and stats hook is still 8 bytes.
+// Copy and move are defaulted, so the tuple is trivially copyable (and usable in constant
+// expressions) whenever all its members are.
+
+template <size_t I, typename T, bool = std::is_empty_v<T> && !std::is_final_v<T>>
+class CompressedTupleElement {
+public:
+    constexpr CompressedTupleElement() : value_() {
+    }
+
+    template <typename U>
+    constexpr CompressedTupleElement(U&& value) : value_(std::forward<U>(value)) {
+    }
+
+    constexpr T& Get() {
+        return value_;
+    }
+
+    constexpr const T& Get() const {
+        return value_;
+    }
+
+private:
+    T value_;
+};
+
+template <size_t I, typename T>
+class CompressedTupleElement<I, T, true> : private T {
+public:
+    constexpr CompressedTupleElement() = default;
+
+    template <typename U>
+    constexpr CompressedTupleElement(U&& value) : T(std::forward<U>(value)) {
+    }
+
+    constexpr T& Get() {
+        return *this;
+    }
+
+    constexpr const T& Get() const {
+        return *this;
+    }
+};
+
+template <typename Indices, typename... Ts>
+class CompressedTupleImpl;
+
+template <size_t... Is, typename... Ts>
+class CompressedTupleImpl<std::index_sequence<Is...>, Ts...> : CompressedTupleElement<Is, Ts>... {
+private:
+    // The element with index `I` is found by deducing the base class, which avoids `std::tuple`.
+    template <size_t I, typename T, bool B>
+    static constexpr T& Element(CompressedTupleElement<I, T, B>& element) {
+        return element.Get();
+    }
+
+    template <size_t I, typename T, bool B>
+    static constexpr const T& Element(const CompressedTupleElement<I, T, B>& element) {
+        return element.Get();
+    }
+
+public:
+    constexpr CompressedTupleImpl() = default;
+
+    template <typename... Args>
+    constexpr CompressedTupleImpl(std::in_place_t, Args&&... args)
+        : CompressedTupleElement<Is, Ts>(std::forward<Args>(args))... {
+    }
+
+    template <size_t I>
+    constexpr auto& Get() {
+        return Element<I>(*this);
+    }
+
+    template <size_t I>
+    constexpr const auto& Get() const {
+        return Element<I>(*this);
+    }
+};
+
+template <typename... Ts>
+class CompressedTuple : public CompressedTupleImpl<std::index_sequence_for<Ts...>, Ts...> {
+private:
+    using Base = CompressedTupleImpl<std::index_sequence_for<Ts...>, Ts...>;
+
+public:
+    constexpr CompressedTuple() = default;
+
+    // One argument per member; never a copy or move of the tuple itself.
+    template <typename... Args>
+        requires(sizeof...(Args) == sizeof...(Ts) && sizeof...(Ts) > 0 &&
+                 (sizeof...(Ts) > 1 ||
+                  (!std::is_same_v<std::remove_cvref_t<Args>, CompressedTuple> && ...)))
+    constexpr CompressedTuple(Args&&... args) : Base(std::in_place, std::forward<Args>(args)...) {
+    }
+};
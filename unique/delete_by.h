@@ -0,0 +1,18 @@
+#pragma once
+
+#include "unique.h"
+
+// Empty deleter that calls the free function `Fn`, e.g. `UniquePtr<FILE, DeleteBy<&fclose>>`.
+// The function is part of the type, so the call is direct (and inlinable), and `CompressedTuple`
+// keeps the pointer the size of a raw pointer. The result of `Fn`, if any, is ignored.
+template <auto Fn>
+class DeleteBy {
+public:
+    template <typename T>
+    void operator()(T* p) const {
+        static_cast<void>(Fn(p));
+    }
+};
+
+template <typename T, auto Fn>
+using UniqueBy = UniquePtr<T, DeleteBy<Fn>>;
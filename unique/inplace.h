@@ -0,0 +1,203 @@
+#pragma once
+
+#include "unique.h"
+
+#include <cstddef>  // std::max_align_t, std::nullptr_t
+#include <new>
+#include <type_traits>
+#include <utility>  // std::exchange
+
+// Owning pointer to a polymorphic `Base` that keeps small derived objects in an inline buffer of
+// `N` bytes instead of on the heap.
+//
+// `Make<Derived>(args...)` constructs in place when `Derived` fits into the buffer, is not
+// over-aligned for it and is nothrow-movable; otherwise it falls back to `new Derived` owned by a
+// `UniquePtr<Base, Deleter>`, so raw pointers and `UniquePtr`s can be adopted as well. Moving an
+// inline object move-constructs it into the destination buffer, so unlike `UniquePtr` the pointer
+// value changes on move.
+//
+// Inline objects never reach `Deleter`: they are destroyed in place. Objects this class allocates
+// itself (the heap fallback of `Make`, and `Release` of an inline object) come from plain `new`,
+// so those two are only available with the default deleter.
+template <typename Base, size_t N, typename Deleter = Slug<Base>,
+          size_t Align = alignof(std::max_align_t)>
+class InplaceUniquePtr {
+private:
+    // One table per inline `Derived`: how to destroy it and how to move it to another buffer.
+    struct Ops {
+        void (*destroy)(Base* object);
+        Base* (*relocate)(void* buffer, Base* object);
+        Base* (*to_heap)(Base* object);
+    };
+
+    template <typename Derived>
+    static constexpr Ops kOps = {
+        [](Base* object) { static_cast<Derived*>(object)->~Derived(); },
+        [](void* buffer, Base* object) -> Base* {
+            auto* from = static_cast<Derived*>(object);
+            Base* result = new (buffer) Derived(std::move(*from));
+            from->~Derived();
+            return result;
+        },
+        [](Base* object) -> Base* {
+            return new Derived(std::move(*static_cast<Derived*>(object)));
+        },
+    };
+
+    alignas(Align) unsigned char buffer_[N];
+    // The inline object; meaningful only while `ops_` is set.
+    Base* inline_ = nullptr;
+    // Null unless the object lives in `buffer_`.
+    const Ops* ops_ = nullptr;
+    UniquePtr<Base, Deleter> heap_;
+
+public:
+    // Whether `Deleter` frees what plain `new` allocates.
+    static constexpr bool kDeletesNew = std::is_same_v<Deleter, Slug<Base>>;
+
+    template <typename Derived>
+    static constexpr bool kFitsInline = sizeof(Derived) <= N && alignof(Derived) <= Align &&
+                                        std::is_nothrow_move_constructible_v<Derived>;
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Constructors
+
+    InplaceUniquePtr() {
+    }
+
+    InplaceUniquePtr(std::nullptr_t) {
+    }
+
+    explicit InplaceUniquePtr(Base* ptr) : heap_(ptr) {
+    }
+
+    InplaceUniquePtr(UniquePtr<Base, Deleter>&& other) noexcept : heap_(std::move(other)) {
+    }
+
+    InplaceUniquePtr(InplaceUniquePtr&& other) noexcept {
+        MoveFrom(other);
+    }
+
+    InplaceUniquePtr(const InplaceUniquePtr&) = delete;
+
+    template <typename Derived, typename... Args>
+    static InplaceUniquePtr Make(Args&&... args) {
+        static_assert(std::is_base_of_v<Base, Derived>);
+        InplaceUniquePtr result;
+        if constexpr (kFitsInline<Derived>) {
+            result.inline_ = new (result.buffer_) Derived(std::forward<Args>(args)...);
+            result.ops_ = &kOps<Derived>;
+        } else {
+            static_assert(kDeletesNew,
+                          "the heap fallback uses plain new, which Deleter cannot free");
+            result.Reset(new Derived(std::forward<Args>(args)...));
+        }
+        return result;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // `operator=`-s
+
+    InplaceUniquePtr& operator=(InplaceUniquePtr&& other) noexcept {
+        if (this != &other) {
+            Reset();
+            MoveFrom(other);
+        }
+        return *this;
+    }
+
+    InplaceUniquePtr& operator=(std::nullptr_t) {
+        Reset();
+        return *this;
+    }
+
+    InplaceUniquePtr& operator=(const InplaceUniquePtr&) = delete;
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Destructor
+
+    ~InplaceUniquePtr() {
+        Reset();
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Modifiers
+
+    // Hand the object over to the caller, to be freed with the deleter. An inline object is moved
+    // to the heap first.
+    Base* Release()
+        requires kDeletesNew
+    {
+        if (ops_ != nullptr) {
+            Base* result = ops_->to_heap(inline_);
+            Reset();
+            return result;
+        }
+        return heap_.Release();
+    }
+
+    void Reset() {
+        if (ops_ != nullptr) {
+            std::exchange(ops_, nullptr)->destroy(std::exchange(inline_, nullptr));
+        } else {
+            heap_ = nullptr;
+        }
+    }
+
+    void Reset(Base* ptr) {
+        Reset();
+        heap_.Reset(ptr);
+    }
+
+    void Swap(InplaceUniquePtr& other) noexcept {
+        InplaceUniquePtr temp(std::move(other));
+        other = std::move(*this);
+        *this = std::move(temp);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Observers
+
+    Base* Get() const {
+        return ops_ != nullptr ? inline_ : heap_.Get();
+    }
+
+    Deleter& GetDeleter() {
+        return heap_.GetDeleter();
+    }
+
+    const Deleter& GetDeleter() const {
+        return heap_.GetDeleter();
+    }
+
+    bool IsInline() const {
+        return ops_ != nullptr;
+    }
+
+    explicit operator bool() const {
+        return Get() != nullptr;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Single-object dereference operators
+
+    Base& operator*() const {
+        return *Get();
+    }
+
+    Base* operator->() const {
+        return Get();
+    }
+
+private:
+    void MoveFrom(InplaceUniquePtr& other) noexcept {
+        if (other.ops_ != nullptr) {
+            inline_ = other.ops_->relocate(buffer_, std::exchange(other.inline_, nullptr));
+            ops_ = std::exchange(other.ops_, nullptr);
+            // The deleter travels with the handle even though an inline object never reaches it.
+            heap_.GetDeleter() = std::move(other.heap_.GetDeleter());
+        } else {
+            heap_ = std::move(other.heap_);
+        }
+    }
+};
@@ -0,0 +1,197 @@
+#pragma once
+
+#include "unique.h"
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <utility>  // std::forward, std::exchange
+#include <vector>
+
+template <typename T>
+class ObjectPool;
+
+// Stateful deleter that hands the object back to its pool. Relies on `UniquePtr::Reset()` going
+// through the stored deleter.
+template <typename T>
+class PoolDeleter {
+public:
+    PoolDeleter() = default;
+
+    explicit PoolDeleter(ObjectPool<T>* pool) : pool_(pool) {
+    }
+
+    void operator()(T* p) const {
+        pool_->Delete(p);
+    }
+
+    ObjectPool<T>* GetPool() const {
+        return pool_;
+    }
+
+private:
+    ObjectPool<T>* pool_ = nullptr;
+};
+
+template <typename T>
+using PoolPtr = UniquePtr<T, PoolDeleter<T>>;
+
+// Recycles storage for `T`s.
+//
+// Every thread keeps a free list of nodes (shared by all pools of the same `T`), so allocation and
+// deallocation are a few plain loads and stores. A thread that frees more than it allocates - the
+// consumer side of a producer/consumer pair - returns surplus nodes to the pool in batches of
+// `kBatchSize`, and a thread whose list runs dry takes a whole batch back, so the shared list is
+// locked once per batch rather than once per object.
+//
+// Nodes are separate heap blocks and never belong to a pool, so a node can be cached by any thread
+// and a pool can be destroyed while other threads still cache nodes. Pointers from `Make()` must
+// not outlive the pool.
+template <typename T>
+class ObjectPool {
+private:
+    struct Node {
+        Node* next;
+    };
+
+    static constexpr size_t kNodeSize = sizeof(T) > sizeof(Node) ? sizeof(T) : sizeof(Node);
+    static constexpr std::align_val_t kNodeAlign{alignof(T) > alignof(Node) ? alignof(T)
+                                                                            : alignof(Node)};
+
+    struct Batch {
+        Node* head;
+        size_t size;
+    };
+
+    struct ThreadCache {
+        Node* head = nullptr;
+        size_t size = 0;
+
+        ~ThreadCache() {
+            FreeNodes(head);
+        }
+    };
+
+    std::mutex mutex_;
+    std::vector<Batch> batches_;
+    std::atomic<size_t> fresh_allocations_ = 0;
+
+public:
+    static constexpr size_t kBatchSize = 64;
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Constructors
+
+    ObjectPool() = default;
+
+    ObjectPool(const ObjectPool&) = delete;
+    ObjectPool& operator=(const ObjectPool&) = delete;
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Destructor
+
+    ~ObjectPool() {
+        for (auto& batch : batches_) {
+            FreeNodes(batch.head);
+        }
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Modifiers
+
+    template <typename... Args>
+    PoolPtr<T> Make(Args&&... args) {
+        return PoolPtr<T>(New(std::forward<Args>(args)...), PoolDeleter<T>(this));
+    }
+
+    template <typename... Args>
+    T* New(Args&&... args) {
+        Node* node = Pop();
+        try {
+            return new (node) T(std::forward<Args>(args)...);
+        } catch (...) {
+            Push(node);
+            throw;
+        }
+    }
+
+    void Delete(T* object) {
+        object->~T();
+        Push(reinterpret_cast<Node*>(object));
+    }
+
+    // Make sure `count` objects can be created without touching the heap.
+    void Reserve(size_t count) {
+        while (count > 0) {
+            Batch batch{nullptr, 0};
+            for (; batch.size < kBatchSize && count > 0; ++batch.size, --count) {
+                batch.head = new (Allocate()) Node{batch.head};
+            }
+            std::lock_guard guard(mutex_);
+            batches_.push_back(batch);
+        }
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Observers
+
+    // Nodes this pool had to take from the heap so far.
+    size_t FreshAllocations() const {
+        return fresh_allocations_.load(std::memory_order_relaxed);
+    }
+
+private:
+    static ThreadCache& LocalCache() {
+        thread_local ThreadCache cache;
+        return cache;
+    }
+
+    Node* Allocate() {
+        fresh_allocations_.fetch_add(1, std::memory_order_relaxed);
+        return static_cast<Node*>(::operator new(kNodeSize, kNodeAlign));
+    }
+
+    static void FreeNodes(Node* node) {
+        while (node != nullptr) {
+            ::operator delete(std::exchange(node, node->next), kNodeAlign);
+        }
+    }
+
+    Node* Pop() {
+        ThreadCache& cache = LocalCache();
+        if (cache.head == nullptr) {
+            std::unique_lock guard(mutex_);
+            if (batches_.empty()) {
+                guard.unlock();
+                return Allocate();
+            }
+            Batch batch = batches_.back();
+            batches_.pop_back();
+            guard.unlock();
+            cache.head = batch.head;
+            cache.size = batch.size;
+        }
+        --cache.size;
+        return std::exchange(cache.head, cache.head->next);
+    }
+
+    void Push(Node* node) {
+        ThreadCache& cache = LocalCache();
+        node->next = cache.head;
+        cache.head = node;
+        ++cache.size;
+        // Keep a batch for local reuse and give the next one back.
+        if (cache.size >= 2 * kBatchSize) {
+            Batch batch{cache.head, kBatchSize};
+            Node* last = cache.head;
+            for (size_t i = 1; i < kBatchSize; ++i) {
+                last = last->next;
+            }
+            cache.head = std::exchange(last->next, nullptr);
+            cache.size -= kBatchSize;
+            std::lock_guard guard(mutex_);
+            batches_.push_back(batch);
+        }
+    }
+};
@@ -0,0 +1,114 @@
+#pragma once
+
+#include "compressed_pair.h"
+
+#include <type_traits>  // std::bool_constant
+#include <utility>  // std::exchange, std::swap
+
+#include <unistd.h>  // close
+
+// Traits describe a handle type: `Traits::Null()` is the value that owns nothing, and
+// `traits.Close(handle)` releases a non-null handle. Traits may carry state (e.g. a context the
+// handle belongs to); empty ones take no space thanks to `CompressedPair`.
+
+struct FdTraits {
+    static constexpr int Null() {
+        return -1;
+    }
+
+    void Close(int fd) const {
+        ::close(fd);
+    }
+};
+
+// `UniquePtr` for handles that are not pointers (file descriptors, epoll sets, memfds...): the
+// handle is stored by value with a sentinel for "none", so owning it costs no allocation.
+template <typename Handle, typename Traits>
+class [[nodiscard]] UniqueResource {
+private:
+    CompressedPair<Handle, Traits> data_;
+
+public:
+    using TriviallyRelocatable =
+        std::bool_constant<std::is_trivially_copyable_v<Handle> &&
+                           std::is_trivially_copyable_v<Traits>>;
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Constructors
+
+    UniqueResource() : data_(Traits::Null(), Traits()) {
+    }
+
+    explicit UniqueResource(Handle handle) : data_(std::move(handle), Traits()) {
+    }
+
+    UniqueResource(Handle handle, Traits traits) : data_(std::move(handle), std::move(traits)) {
+    }
+
+    UniqueResource(UniqueResource&& other) noexcept
+        : data_(other.Release(), std::move(other.GetTraits())) {
+    }
+
+    UniqueResource(const UniqueResource&) = delete;
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // `operator=`-s
+
+    UniqueResource& operator=(UniqueResource&& other) noexcept {
+        if (this != &other) {
+            Reset(other.Release());
+            GetTraits() = std::move(other.GetTraits());
+        }
+        return *this;
+    }
+
+    UniqueResource& operator=(const UniqueResource&) = delete;
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Destructor
+
+    ~UniqueResource() {
+        Reset();
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Modifiers
+
+    // The caller becomes responsible for closing the handle.
+    [[nodiscard]] Handle Release() {
+        return std::exchange(data_.GetFirst(), Traits::Null());
+    }
+
+    void Reset(Handle handle = Traits::Null()) {
+        Handle old = std::exchange(data_.GetFirst(), std::move(handle));
+        if (old != Traits::Null()) {
+            GetTraits().Close(old);
+        }
+    }
+
+    void Swap(UniqueResource& other) noexcept {
+        std::swap(data_.GetFirst(), other.data_.GetFirst());
+        std::swap(data_.GetSecond(), other.data_.GetSecond());
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Observers
+
+    const Handle& Get() const {
+        return data_.GetFirst();
+    }
+
+    Traits& GetTraits() {
+        return data_.GetSecond();
+    }
+
+    const Traits& GetTraits() const {
+        return data_.GetSecond();
+    }
+
+    explicit operator bool() const {
+        return Get() != Traits::Null();
+    }
+};
+
+using UniqueFd = UniqueResource<int, FdTraits>;
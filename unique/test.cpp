@@ -354,6 +354,30 @@ TEST_CASE("Moving deleters") {
     }
 }
 
+TEST_CASE("Reset with deleters") {
+    SECTION("Reset goes through the stored deleter") {
+        UniquePtr<MyInt, Deleter<MyInt>> s(new MyInt, Deleter<MyInt>(5));
+        s.Reset(new MyInt);
+
+        REQUIRE(s.GetDeleter().WasCalled());
+        REQUIRE(s.GetDeleter().GetTag() == 5);
+        REQUIRE(MyInt::AliveCount() == 1);
+
+        s.Reset();
+
+        REQUIRE(MyInt::AliveCount() == 0);
+        REQUIRE(s.GetDeleter().GetTag() == 5);
+    }
+
+    SECTION("Array reset keeps the deleter") {
+        UniquePtr<MyInt[], Deleter<MyInt[]>> s(new MyInt[2], Deleter<MyInt[]>(7));
+        s.Reset(new MyInt[3]);
+
+        REQUIRE(MyInt::AliveCount() == 3);
+        REQUIRE(s.GetDeleter().GetTag() == 7);
+    }
+}
+
 TEST_CASE("GetDeleter") {
     SECTION("Get deleter") {
         UniquePtr<MyInt, Deleter<MyInt>> p;
@@ -503,4 +527,22 @@ TEST_CASE("Upcasts") {
         UniquePtr<MyInt, Deleter<MyInt>> s2(new MyInt);
         s2 = std::move(s);
     }
+
+    SECTION("Upcast to const") {
+        UniquePtr<MyInt> s(new MyInt(3));
+        UniquePtr<const MyInt> s2(std::move(s));
+        UniquePtr<const MyInt> s3;
+        s3 = std::move(s2);
+
+        REQUIRE(s2.Get() == nullptr);
+        REQUIRE(*s3 == 3);
+    }
+
+    SECTION("Only implicit conversions") {
+        static_assert(std::is_constructible_v<UniquePtr<Person>, UniquePtr<Alice>&&>);
+        static_assert(!std::is_constructible_v<UniquePtr<Alice>, UniquePtr<Person>&&>);
+        static_assert(!std::is_assignable_v<UniquePtr<Alice>&, UniquePtr<Bob>&&>);
+        static_assert(!std::is_constructible_v<UniquePtr<MyInt, Deleter<MyInt>>,
+                                               UniquePtr<MyInt, CopyableDeleter<MyInt>>&&>);
+    }
 }
@@ -0,0 +1,63 @@
+#include "aligned.h"
+
+#include <catch.hpp>
+
+#include <cstdint>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+bool IsAligned(const void* ptr, size_t alignment) {
+    return reinterpret_cast<uintptr_t>(ptr) % alignment == 0;
+}
+
+}  // namespace
+
+TEST_CASE("Aligned arrays") {
+    SECTION("Alignment and length") {
+        auto floats = MakeUniqueAligned<float[]>(1000);
+        auto page = MakeUniqueAligned<char[]>(10, kPageAlignment);
+
+        REQUIRE(IsAligned(floats.Get(), kCacheLineAlignment));
+        REQUIRE(IsAligned(page.Get(), kPageAlignment));
+        REQUIRE(floats.Size() == 1000);
+        REQUIRE(page.Size() == 10);
+        REQUIRE(floats.GetDeleter().Alignment() == kCacheLineAlignment);
+        REQUIRE(floats[999] == 0.0f);
+    }
+
+    SECTION("Span") {
+        auto values = MakeUniqueAligned<int[]>(100);
+        std::span<int> span = values.Span();
+        std::iota(span.begin(), span.end(), 0);
+        REQUIRE(span.size() == 100);
+        REQUIRE(std::accumulate(span.begin(), span.end(), 0) == 4950);
+        REQUIRE(values[42] == 42);
+    }
+
+    SECTION("Non-trivial elements") {
+        auto strings = MakeUniqueAligned<std::string[]>(3, 128);
+        strings[0] = "a long string that does not fit into the small buffer";
+        REQUIRE(strings.Span().back().empty());
+
+        AlignedArray<std::string[]> moved = std::move(strings);
+        REQUIRE(strings.Size() == 0);
+        REQUIRE(!strings);
+        REQUIRE(moved.Size() == 3);
+        REQUIRE(moved[0].size() > 20);
+    }
+
+    SECTION("Bad alignment") {
+        REQUIRE_THROWS_AS(MakeUniqueAligned<int[]>(1, 48), std::invalid_argument);
+        REQUIRE_THROWS_AS(MakeUniqueAligned<double[]>(1, 4), std::invalid_argument);
+    }
+
+    SECTION("Layout") {
+        static_assert(sizeof(AlignedArray<float[]>) == 3 * sizeof(void*));
+        static_assert(sizeof(UniquePtr<float[]>) == sizeof(void*));
+    }
+}
@@ -0,0 +1,110 @@
+#include "arena.h"
+
+#include <catch.hpp>
+
+#include "allocations_checker.h"
+
+#include <cstdint>
+#include <string>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+struct Node {
+    Node(int value, Node* next) : value(value), next(next) {
+    }
+
+    int value;
+    Node* next;
+};
+
+struct Named {
+    explicit Named(std::string name) : name(std::move(name)) {
+        ++alive;
+    }
+
+    ~Named() {
+        --alive;
+    }
+
+    std::string name;
+
+    static inline int alive = 0;
+};
+
+}  // namespace
+
+TEST_CASE("Arena layout") {
+    static_assert(sizeof(ArenaPtr<Node>) == sizeof(void*));
+    static_assert(sizeof(ArenaPtr<std::string>) == sizeof(void*));
+    static_assert(std::is_empty_v<ArenaDeleter<Named>>);
+}
+
+TEST_CASE("Arena allocation") {
+    MonotonicArena arena(256);
+
+    SECTION("Alignment") {
+        arena.Allocate(1, 1);
+        void* aligned = arena.Allocate(64, 64);
+        REQUIRE(reinterpret_cast<uintptr_t>(aligned) % 64 == 0);
+        auto* value = arena.New<double>(1.5);
+        REQUIRE(reinterpret_cast<uintptr_t>(value) % alignof(double) == 0);
+        REQUIRE(*value == 1.5);
+    }
+
+    SECTION("Growth") {
+        Node* head = nullptr;
+        for (int i = 0; i < 1000; ++i) {
+            head = arena.New<Node>(i, head);
+        }
+        void* large = arena.Allocate(10'000);
+        REQUIRE(large != nullptr);
+        int sum = 0;
+        for (Node* node = head; node != nullptr; node = node->next) {
+            sum += node->value;
+        }
+        REQUIRE(sum == 999 * 1000 / 2);
+    }
+
+    SECTION("Reset reuses memory") {
+        for (int i = 0; i < 100; ++i) {
+            arena.New<Node>(i, nullptr);
+        }
+        arena.Reset();
+        size_t available = arena.Available();
+        EXPECT_ZERO_ALLOCATIONS(arena.New<Node>(1, nullptr));
+        REQUIRE(arena.Available() < available);
+    }
+}
+
+TEST_CASE("Arena with zero initial chunk size") {
+    MonotonicArena arena(0);
+    auto* value = arena.New<Node>(1, nullptr);
+    REQUIRE(value->value == 1);
+    void* large = arena.Allocate(1000);
+    REQUIRE(large != nullptr);
+    REQUIRE(arena.Available() > 0);
+}
+
+TEST_CASE("Arena pointers") {
+    MonotonicArena arena;
+    {
+        auto a = MakeArenaUnique<Named>(arena, "a");
+        auto b = MakeArenaUnique<Named>(arena, "b");
+        REQUIRE(Named::alive == 2);
+
+        ArenaPtr<Named> c = std::move(a);
+        REQUIRE(!a);
+        REQUIRE(c->name == "a");
+
+        b = nullptr;
+        REQUIRE(Named::alive == 1);
+
+        // Trivially destructible: the deleter does nothing at all.
+        auto node = MakeArenaUnique<Node>(arena, 1, nullptr);
+        REQUIRE(node->value == 1);
+    }
+    REQUIRE(Named::alive == 0);
+    arena.Reset();
+}
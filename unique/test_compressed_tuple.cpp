@@ -0,0 +1,71 @@
+#include "compressed_tuple.h"
+#include "unique.h"
+
+#include <catch.hpp>
+
+#include <string>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+struct Empty {};
+
+struct Allocator {
+    int Allocate() const {
+        return 42;
+    }
+};
+
+struct Stats {};
+
+struct FinalEmpty final {};
+
+struct Deleter {
+    void operator()(int* p) const {
+        delete p;
+    }
+};
+
+}  // namespace
+
+TEST_CASE("Compressed tuple layout") {
+    static_assert(sizeof(CompressedTuple<int*, Deleter, Allocator, Stats>) == sizeof(int*));
+    static_assert(sizeof(CompressedTuple<int*, Empty>) == sizeof(int*));
+    static_assert(sizeof(CompressedTuple<int*, FinalEmpty>) > sizeof(int*));
+    static_assert(sizeof(CompressedTuple<int, int, int>) == 3 * sizeof(int));
+
+    static_assert(std::is_trivially_copyable_v<CompressedTuple<int*, Deleter, Stats>>);
+    static_assert(!std::is_trivially_copyable_v<CompressedTuple<int*, std::string>>);
+
+    static_assert(sizeof(UniquePtr<int, Deleter>) == sizeof(int*));
+}
+
+TEST_CASE("Compressed tuple access") {
+    SECTION("Constexpr") {
+        constexpr CompressedTuple<int, Empty, long> kTuple(1, Empty{}, 2L);
+        static_assert(kTuple.Get<0>() == 1);
+        static_assert(kTuple.Get<2>() == 2);
+    }
+
+    SECTION("Mutation and moves") {
+        CompressedTuple<std::string, Allocator, int> tuple("abc", Allocator{}, 3);
+        tuple.Get<0>() += "d";
+        tuple.Get<2>() = 4;
+        REQUIRE(tuple.Get<1>().Allocate() == 42);
+
+        auto moved = std::move(tuple);
+        REQUIRE(moved.Get<0>() == "abcd");
+        REQUIRE(moved.Get<2>() == 4);
+
+        CompressedTuple<std::string, Allocator, int> copy;
+        copy = moved;
+        REQUIRE(copy.Get<0>() == "abcd");
+    }
+
+    SECTION("Single member") {
+        CompressedTuple<std::string> a("x");
+        CompressedTuple<std::string> b(a);
+        REQUIRE(b.Get<0>() == "x");
+    }
+}
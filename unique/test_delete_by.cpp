@@ -0,0 +1,60 @@
+#include "delete_by.h"
+
+#include <catch.hpp>
+
+#include <cstdio>
+#include <cstdlib>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+struct Handle {
+    int id;
+};
+
+int closed = 0;
+
+Handle* OpenHandle(int id) {
+    return new Handle{id};
+}
+
+int CloseHandle(Handle* handle) {
+    closed += handle->id;
+    delete handle;
+    return 0;
+}
+
+}  // namespace
+
+TEST_CASE("DeleteBy") {
+    SECTION("Layout") {
+        static_assert(std::is_empty_v<DeleteBy<&CloseHandle>>);
+        static_assert(sizeof(UniqueBy<Handle, &CloseHandle>) == sizeof(void*));
+        static_assert(sizeof(UniqueBy<FILE, &fclose>) == sizeof(void*));
+    }
+
+    SECTION("Calls the function") {
+        closed = 0;
+        {
+            UniqueBy<Handle, &CloseHandle> a(OpenHandle(1));
+            UniqueBy<Handle, &CloseHandle> b(OpenHandle(2));
+            a = std::move(b);
+            REQUIRE(closed == 1);
+            a.Reset(OpenHandle(4));
+            REQUIRE(closed == 3);
+
+            UniqueBy<Handle, &CloseHandle> empty;
+        }
+        REQUIRE(closed == 7);
+    }
+
+    SECTION("C resources") {
+        UniqueBy<FILE, &fclose> file(std::tmpfile());
+        REQUIRE(file);
+        REQUIRE(std::fputs("abc", file.Get()) >= 0);
+
+        UniqueBy<void, &free> memory(malloc(16));
+        REQUIRE(memory.Get() != nullptr);
+    }
+}
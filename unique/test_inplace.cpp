@@ -0,0 +1,217 @@
+#include "inplace.h"
+
+#include <catch.hpp>
+
+#include <cstdint>
+#include <string>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+struct Filter {
+    virtual int Apply(int value) const = 0;
+    virtual ~Filter() {
+        ++destroyed;
+    }
+
+    static inline int destroyed = 0;
+};
+
+struct AddFilter : Filter {
+    explicit AddFilter(int delta) : delta(delta) {
+    }
+
+    int Apply(int value) const override {
+        return value + delta;
+    }
+
+    int delta;
+};
+
+struct BigFilter : Filter {
+    int Apply(int value) const override {
+        return value * 2 + static_cast<int>(padding[0]);
+    }
+
+    char padding[256] = {};
+};
+
+// Base is not the first subobject, so the `Filter*` is not the start of the object.
+struct Named {
+    Named() = default;
+    Named(Named&&) noexcept = default;
+    virtual ~Named() = default;
+    std::string name = "shifted";
+};
+
+struct ShiftedFilter : Named, Filter {
+    int Apply(int value) const override {
+        return value - static_cast<int>(name.size());
+    }
+};
+
+struct alignas(64) AlignedFilter : Filter {
+    int Apply(int value) const override {
+        return value;
+    }
+};
+
+using FilterPtr = InplaceUniquePtr<Filter, 48>;
+
+// Frees something other than plain `new` (think of a pool or an arena).
+struct CustomDelete {
+    void operator()(Filter* filter) const {
+        filter->~Filter();
+        ++calls;
+    }
+
+    static inline int calls = 0;
+};
+
+using CustomFilterPtr = InplaceUniquePtr<Filter, 48, CustomDelete>;
+
+struct CountingDelete {
+    void operator()(Filter* filter) const {
+        filter->~Filter();
+        ++*calls;
+    }
+
+    int* calls = nullptr;
+};
+
+using CountingFilterPtr = InplaceUniquePtr<Filter, 48, CountingDelete>;
+
+template <typename Ptr>
+concept Releasable = requires(Ptr& p) { p.Release(); };
+
+}  // namespace
+
+TEST_CASE("Inplace storage") {
+    static_assert(FilterPtr::kFitsInline<AddFilter>);
+    static_assert(FilterPtr::kFitsInline<ShiftedFilter>);
+    static_assert(!FilterPtr::kFitsInline<BigFilter>);
+    static_assert(!FilterPtr::kFitsInline<AlignedFilter>);
+    static_assert(std::is_nothrow_move_constructible_v<FilterPtr>);
+
+    Filter::destroyed = 0;
+    {
+        auto small = FilterPtr::Make<AddFilter>(5);
+        auto big = FilterPtr::Make<BigFilter>();
+        auto aligned = FilterPtr::Make<AlignedFilter>();
+        REQUIRE(small.IsInline());
+        REQUIRE(!big.IsInline());
+        REQUIRE(!aligned.IsInline());
+        REQUIRE(reinterpret_cast<uintptr_t>(aligned.Get()) % 64 == 0);
+
+        REQUIRE(small->Apply(1) == 6);
+        REQUIRE(big->Apply(1) == 2);
+        REQUIRE((*aligned).Apply(3) == 3);
+        REQUIRE(reinterpret_cast<const void*>(small.Get()) ==
+                reinterpret_cast<const void*>(&small));
+    }
+    REQUIRE(Filter::destroyed == 3);
+}
+
+TEST_CASE("Inplace moves") {
+    Filter::destroyed = 0;
+    {
+        auto a = FilterPtr::Make<ShiftedFilter>();
+        REQUIRE(a.IsInline());
+        REQUIRE(a->Apply(10) == 3);
+
+        FilterPtr b(std::move(a));
+        REQUIRE(!a);
+        REQUIRE(a.Get() == nullptr);
+        REQUIRE(b->Apply(10) == 3);
+        // Moving the inline object destroys the source.
+        REQUIRE(Filter::destroyed == 1);
+
+        auto c = FilterPtr::Make<BigFilter>();
+        Filter* heap = c.Get();
+        b = std::move(c);
+        REQUIRE(b.Get() == heap);
+        REQUIRE(Filter::destroyed == 2);
+
+        c = FilterPtr::Make<AddFilter>(1);
+        b.Swap(c);
+        REQUIRE(b->Apply(1) == 2);
+        REQUIRE(c.Get() == heap);
+
+        b = nullptr;
+        REQUIRE(!b);
+    }
+    REQUIRE(Filter::destroyed == 7);
+}
+
+TEST_CASE("Inplace interop with UniquePtr") {
+    Filter::destroyed = 0;
+    {
+        UniquePtr<Filter> unique(new AddFilter(2));
+        Filter* raw = unique.Get();
+        FilterPtr a(std::move(unique));
+        REQUIRE(!unique);
+        REQUIRE(a.Get() == raw);
+        REQUIRE(!a.IsInline());
+
+        // Releasing an inline object moves it to the heap.
+        auto b = FilterPtr::Make<AddFilter>(3);
+        UniquePtr<Filter> released(b.Release());
+        REQUIRE(!b);
+        REQUIRE(released->Apply(1) == 4);
+
+        FilterPtr c(new AddFilter(4));
+        c.Reset(new AddFilter(5));
+        REQUIRE(c->Apply(0) == 5);
+    }
+    REQUIRE(Filter::destroyed == 5);
+}
+
+TEST_CASE("Inplace with a custom deleter") {
+    static_assert(FilterPtr::kDeletesNew);
+    static_assert(!CustomFilterPtr::kDeletesNew);
+    // Both would hand out memory from plain `new`, which `CustomDelete` cannot free.
+    static_assert(Releasable<FilterPtr>);
+    static_assert(!Releasable<CustomFilterPtr>);
+
+    Filter::destroyed = 0;
+    CustomDelete::calls = 0;
+    {
+        // Inline objects are destroyed in place and never reach the deleter.
+        auto a = CustomFilterPtr::Make<AddFilter>(1);
+        REQUIRE(a.IsInline());
+        REQUIRE(a->Apply(1) == 2);
+
+        alignas(AddFilter) unsigned char storage[sizeof(AddFilter)];
+        CustomFilterPtr b(new (storage) AddFilter(2));
+        REQUIRE(!b.IsInline());
+        REQUIRE(b.Get() == reinterpret_cast<Filter*>(storage));
+        REQUIRE(b->Apply(1) == 3);
+    }
+    REQUIRE(Filter::destroyed == 2);
+    REQUIRE(CustomDelete::calls == 1);
+}
+
+TEST_CASE("Inplace keeps a stateful deleter") {
+    int calls = 0;
+    alignas(AddFilter) unsigned char first[sizeof(AddFilter)];
+    alignas(AddFilter) unsigned char second[sizeof(AddFilter)];
+
+    CountingFilterPtr a;
+    a.GetDeleter().calls = &calls;
+    a.Reset(new (first) AddFilter(1));
+    a.Reset(new (second) AddFilter(2));
+    REQUIRE(calls == 1);
+    REQUIRE(a->Apply(0) == 2);
+    a = nullptr;
+    REQUIRE(calls == 2);
+
+    // Moving an inline object carries the deleter along as well.
+    a = CountingFilterPtr::Make<AddFilter>(3);
+    a.GetDeleter().calls = &calls;
+    CountingFilterPtr b(std::move(a));
+    REQUIRE(b.IsInline());
+    b.Reset(new (first) AddFilter(4));
+    b.Reset();
+    REQUIRE(calls == 3);
+}
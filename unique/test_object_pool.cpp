@@ -0,0 +1,141 @@
+#include "object_pool.h"
+
+#include <catch.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+struct Message {
+    explicit Message(std::string text) : text(std::move(text)) {
+        ++alive;
+    }
+
+    ~Message() {
+        --alive;
+    }
+
+    std::string text;
+
+    static inline std::atomic<int> alive = 0;
+};
+
+struct alignas(64) Wide {
+    explicit Wide(int value) : value(value) {
+        if (value < 0) {
+            throw std::invalid_argument("negative");
+        }
+    }
+
+    int value;
+};
+
+}  // namespace
+
+TEST_CASE("Object pool reuse") {
+    ObjectPool<Message> pool;
+    {
+        auto a = pool.Make("a");
+        Message* address = a.Get();
+        a = nullptr;
+        auto b = pool.Make("b");
+        REQUIRE(b.Get() == address);
+        REQUIRE(b->text == "b");
+        REQUIRE(Message::alive == 1);
+    }
+    REQUIRE(Message::alive == 0);
+    REQUIRE(pool.FreshAllocations() <= 1);
+}
+
+TEST_CASE("Object pool deleter is kept on reset") {
+    ObjectPool<Message> pool;
+    auto ptr = pool.Make("first");
+    ptr.Reset(pool.New("second"));
+    REQUIRE(ptr.GetDeleter().GetPool() == &pool);
+    REQUIRE(Message::alive == 1);
+    ptr.Reset();
+    REQUIRE(Message::alive == 0);
+
+    PoolPtr<Message> moved = pool.Make("third");
+    PoolPtr<Message> target;
+    target = std::move(moved);
+    REQUIRE(target.GetDeleter().GetPool() == &pool);
+}
+
+TEST_CASE("Object pool deleter survives nulling, release and moves") {
+    ObjectPool<Message> pool;
+
+    SECTION("Assigning nullptr") {
+        auto ptr = pool.Make("first");
+        ptr = nullptr;
+        REQUIRE(ptr.GetDeleter().GetPool() == &pool);
+        ptr.Reset(pool.New("second"));
+        REQUIRE(ptr->text == "second");
+    }
+
+    SECTION("Release") {
+        auto ptr = pool.Make("first");
+        Message* released = ptr.Release();
+        REQUIRE(ptr.GetDeleter().GetPool() == &pool);
+        ptr.Reset(released);
+        REQUIRE(ptr->text == "first");
+    }
+
+    SECTION("Moved-from") {
+        auto ptr = pool.Make("first");
+        PoolPtr<Message> target(std::move(ptr));
+        REQUIRE(ptr.GetDeleter().GetPool() == &pool);
+        ptr.Reset(pool.New("second"));
+        REQUIRE(ptr->text == "second");
+        REQUIRE(target->text == "first");
+    }
+
+    REQUIRE(Message::alive == 0);
+}
+
+TEST_CASE("Object pool alignment and exceptions") {
+    ObjectPool<Wide> pool;
+    std::vector<PoolPtr<Wide>> ptrs;
+    for (int i = 0; i < 10; ++i) {
+        ptrs.push_back(pool.Make(i));
+        REQUIRE(reinterpret_cast<uintptr_t>(ptrs.back().Get()) % 64 == 0);
+    }
+    size_t allocated = pool.FreshAllocations();
+    REQUIRE_THROWS_AS(pool.Make(-1), std::invalid_argument);
+    // The node of the failed construction went back to the free list.
+    auto ok = pool.Make(1);
+    REQUIRE(pool.FreshAllocations() == allocated + 1);
+}
+
+TEST_CASE("Object pool cross-thread returns") {
+    constexpr int kRounds = 20;
+    constexpr size_t kCount = 4 * ObjectPool<Message>::kBatchSize;
+
+    ObjectPool<Message> pool;
+    pool.Reserve(kCount);
+    size_t reserved = pool.FreshAllocations();
+
+    // Producer allocates, consumer frees: the nodes must flow back to the producer in batches.
+    for (int round = 0; round < kRounds; ++round) {
+        std::vector<PoolPtr<Message>> messages;
+        std::thread producer([&]() {
+            for (size_t i = 0; i < kCount; ++i) {
+                messages.push_back(pool.Make("message"));
+            }
+        });
+        producer.join();
+        std::thread consumer([&]() { messages.clear(); });
+        consumer.join();
+    }
+    REQUIRE(Message::alive == 0);
+    // Each consumer thread may keep up to two batches cached until it exits.
+    REQUIRE(pool.FreshAllocations() <= reserved + kRounds * 2 * ObjectPool<Message>::kBatchSize);
+    REQUIRE(pool.FreshAllocations() < reserved + kRounds * kCount);
+}
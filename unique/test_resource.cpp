@@ -0,0 +1,90 @@
+#include "resource.h"
+
+#include <catch.hpp>
+
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+bool IsOpen(int fd) {
+    return ::fcntl(fd, F_GETFD) != -1;
+}
+
+// Handles are indices into a table owned by the traits.
+struct TableTraits {
+    static constexpr int Null() {
+        return 0;
+    }
+
+    void Close(int handle) const {
+        closed->push_back(handle);
+    }
+
+    std::vector<int>* closed = nullptr;
+};
+
+}  // namespace
+
+TEST_CASE("UniqueResource") {
+    SECTION("Layout") {
+        static_assert(sizeof(UniqueFd) == sizeof(int));
+        static_assert(sizeof(UniqueResource<int, TableTraits>) == 2 * sizeof(void*));
+        static_assert(std::is_nothrow_move_constructible_v<UniqueFd>);
+        static_assert(!std::is_copy_constructible_v<UniqueFd>);
+    }
+
+    SECTION("File descriptors") {
+        int fds[2];
+        REQUIRE(::pipe(fds) == 0);
+        {
+            UniqueFd read_end(fds[0]);
+            UniqueFd write_end(fds[1]);
+            REQUIRE(read_end);
+            REQUIRE(read_end.Get() == fds[0]);
+
+            UniqueFd moved(std::move(read_end));
+            REQUIRE(!read_end);
+            REQUIRE(read_end.Get() == -1);
+            REQUIRE(IsOpen(fds[0]));
+
+            write_end.Reset();
+            REQUIRE(!IsOpen(fds[1]));
+        }
+        REQUIRE(!IsOpen(fds[0]));
+    }
+
+    SECTION("Release and swap") {
+        int fds[2];
+        REQUIRE(::pipe(fds) == 0);
+        UniqueFd a(fds[0]);
+        UniqueFd b(fds[1]);
+        a.Swap(b);
+        REQUIRE(a.Get() == fds[1]);
+
+        int raw = a.Release();
+        REQUIRE(!a);
+        REQUIRE(IsOpen(raw));
+        ::close(raw);
+
+        b = UniqueFd();
+        REQUIRE(!IsOpen(fds[0]));
+    }
+
+    SECTION("Stateful traits") {
+        std::vector<int> closed;
+        {
+            UniqueResource<int, TableTraits> a(3, TableTraits{&closed});
+            UniqueResource<int, TableTraits> b(4, TableTraits{&closed});
+            a = std::move(b);
+            REQUIRE(closed == std::vector<int>{3});
+            REQUIRE(a.GetTraits().closed == &closed);
+            a.Reset(5);
+        }
+        REQUIRE(closed == std::vector<int>{3, 4, 5});
+    }
+}
@@ -1,8 +1,13 @@
 #pragma once
 
-#include "compressed_pair.h"
+#include "compressed_tuple.h"
+
+#include <common/trivial_abi.h>
 
 #include <cstddef>  // std::nullptr_t
+#include <span>
+#include <type_traits>  // std::bool_constant
+#include <utility>  // std::exchange
 
 template <class T>
 class Slug {
@@ -57,14 +62,18 @@ public:
 
 // Primary template
 template <typename T, typename Deleter = Slug<T>>
-class UniquePtr {
+class SMART_PTRS_TRIVIAL_ABI UniquePtr {
 private:
-    CompressedPair<T*, Deleter> ptr_;
+    CompressedTuple<T*, Deleter> ptr_;
 
 public:
+    // Relocatable with a byte copy as long as the deleter is (see `IsTriviallyRelocatable`).
+    using TriviallyRelocatable = std::bool_constant<std::is_trivially_copyable_v<Deleter>>;
+
+    // Drop the pointer without freeing it. The deleter stays, as with `std::unique_ptr`: a
+    // stateful deleter (e.g. a pool handle) survives moves, `Release()` and `= nullptr`.
     void Clear() {
-        ptr_.GetFirst() = nullptr;
-        ptr_.GetSecond() = Deleter();
+        ptr_.template Get<0>() = nullptr;
     }
 
     ////////////////////////////////////////////////////////////////////////////////////////////////
@@ -80,7 +89,7 @@ public:
     }
 
     UniquePtr(UniquePtr&& other) noexcept
-        : ptr_(std::forward<CompressedPair<T*, Deleter>>(other.ptr_)) {
+        : ptr_(std::move(other.ptr_)) {
         other.Clear();
     }
 
@@ -90,11 +99,11 @@ public:
     // `operator=`-s
 
     UniquePtr& operator=(UniquePtr&& other) noexcept {
-        if (other.ptr_.GetFirst() == ptr_.GetFirst()) {
+        if (other.ptr_.template Get<0>() == ptr_.template Get<0>()) {
             return *this;
         }
         Destructor();
-        ptr_ = std::forward<CompressedPair<T*, Deleter>>(other.ptr_);
+        ptr_ = std::move(other.ptr_);
         other.Clear();
         return *this;
     }
@@ -108,17 +117,11 @@ public:
     ////////////////////////////////////////////////////////////////////////////////////////////////
     // Constructors with Templates
 
+    // Upcasts only: the conversions are checked at compile time and need no RTTI.
     template <typename S, typename D>
+        requires(std::is_convertible_v<S*, T*> && std::is_convertible_v<D, Deleter>)
     UniquePtr(UniquePtr<S, D>&& other) noexcept
-        : ptr_(std::forward<T*>(dynamic_cast<T*>(other.Get())),
-               std::forward<Deleter>(*dynamic_cast<Deleter*>(&other.GetDeleter()))) {
-        other.Clear();
-    }
-
-    template <typename S>
-    UniquePtr(UniquePtr<S>&& other) noexcept
-        : ptr_(std::forward<T*>(dynamic_cast<T*>(other.Get())),
-               std::forward<Deleter>(other.GetDeleter())) {
+        : ptr_(static_cast<T*>(other.Get()), Deleter(std::move(other.GetDeleter()))) {
         other.Clear();
     }
 
@@ -126,26 +129,14 @@ public:
     // `operator=`-s with Templates
 
     template <typename S, typename D>
+        requires(std::is_convertible_v<S*, T*> && std::is_convertible_v<D, Deleter>)
     UniquePtr& operator=(UniquePtr<S, D>&& other) noexcept {
-        if (dynamic_cast<T*>(other.Get()) == ptr_.GetFirst()) {
+        if (static_cast<T*>(other.Get()) == ptr_.template Get<0>()) {
             return *this;
         }
         Destructor();
-        ptr_ = CompressedPair<T*, Deleter>(
-            std::forward<T*>(dynamic_cast<T*>(other.Get())),
-            std::forward<Deleter>(*dynamic_cast<Deleter*>(&other.GetDeleter())));
-        other.Clear();
-        return *this;
-    }
-
-    template <typename S>
-    UniquePtr& operator=(UniquePtr<S>&& other) noexcept {
-        if (dynamic_cast<T*>(other.Get()) == ptr_.GetFirst()) {
-            return *this;
-        }
-        Destructor();
-        ptr_ = CompressedPair<T*, Deleter>(std::forward<T*>(dynamic_cast<T*>(other.Get())),
-                                           std::forward<Deleter>(other.GetDeleter()));
+        ptr_.template Get<0>() = static_cast<T*>(other.Get());
+        ptr_.template Get<1>() = Deleter(std::move(other.GetDeleter()));
         other.Clear();
         return *this;
     }
@@ -173,44 +164,47 @@ public:
         return ptr;
     }
 
+    // The old object goes through the stored deleter, which is kept: a stateful deleter (e.g. a
+    // pool handle) stays attached to the pointer.
     void Reset(T* ptr = nullptr) {
-        if (ptr == ptr_.GetFirst()) {
+        if (ptr == ptr_.template Get<0>()) {
             return;
         }
-        auto temp = ptr_.GetFirst();
-        ptr_ = CompressedPair<T*, Deleter>(ptr, Deleter());
-        delete temp;
+        auto temp = std::exchange(ptr_.template Get<0>(), ptr);
+        if (temp != nullptr) {
+            GetDeleter()(temp);
+        }
     }
 
     void Swap(UniquePtr& other) {
-        std::swap(ptr_.GetFirst(), other.ptr_.GetFirst());
-        std::swap(ptr_.GetSecond(), other.ptr_.GetSecond());
+        std::swap(ptr_.template Get<0>(), other.ptr_.template Get<0>());
+        std::swap(ptr_.template Get<1>(), other.ptr_.template Get<1>());
     }
 
     ////////////////////////////////////////////////////////////////////////////////////////////////
     // Observers
 
     T* Get() const {
-        return ptr_.GetFirst();
+        return ptr_.template Get<0>();
     }
     Deleter& GetDeleter() {
-        return ptr_.GetSecond();
+        return ptr_.template Get<1>();
     }
 
     const Deleter& GetDeleter() const {
-        return ptr_.GetSecond();
+        return ptr_.template Get<1>();
     }
 
     Deleter& GetCD() {
-        return ptr_;
+        return ptr_.template Get<1>();
     }
 
     const Deleter& GetCD() const {
-        return ptr_;
+        return ptr_.template Get<1>();
     }
 
     explicit operator bool() const {
-        return ptr_.GetFirst() != nullptr;
+        return ptr_.template Get<0>() != nullptr;
     }
 
     ////////////////////////////////////////////////////////////////////////////////////////////////
@@ -231,16 +225,20 @@ public:
 
 // Specialization for arrays
 template <typename T, typename Deleter>
-class UniquePtr<T[], Deleter> {
+class SMART_PTRS_TRIVIAL_ABI UniquePtr<T[], Deleter> {
 private:
-    CompressedPair<T*, Deleter> ptr_;
+    CompressedTuple<T*, Deleter> ptr_;
 
+    // Drop the pointer without freeing it. The deleter stays, as with `std::unique_ptr`: a
+    // stateful deleter (e.g. a pool handle) survives moves, `Release()` and `= nullptr`.
     void Clear() {
-        ptr_.GetFirst() = nullptr;
-        ptr_.GetSecond() = Deleter();
+        ptr_.template Get<0>() = nullptr;
     }
 
 public:
+    // Relocatable with a byte copy as long as the deleter is (see `IsTriviallyRelocatable`).
+    using TriviallyRelocatable = std::bool_constant<std::is_trivially_copyable_v<Deleter>>;
+
     ////////////////////////////////////////////////////////////////////////////////////////////////
     // Constructors
 
@@ -254,7 +252,7 @@ public:
     }
 
     UniquePtr(UniquePtr&& other) noexcept
-        : ptr_(std::forward<CompressedPair<T*, Deleter>>(other.ptr_)) {
+        : ptr_(std::move(other.ptr_)) {
         other.Clear();
     }
 
@@ -264,11 +262,11 @@ public:
     // `operator=`-s
 
     UniquePtr& operator=(UniquePtr&& other) noexcept {
-        if (other.ptr_.GetFirst() == ptr_.GetFirst()) {
+        if (other.ptr_.template Get<0>() == ptr_.template Get<0>()) {
             return *this;
         }
         Destructor();
-        ptr_ = std::forward<CompressedPair<T*, Deleter>>(other.ptr_);
+        ptr_ = std::move(other.ptr_);
         other.Clear();
         return *this;
     }
@@ -303,36 +301,46 @@ public:
     }
 
     void Reset(T* ptr = nullptr) {
-        if (ptr == ptr_.GetFirst()) {
+        if (ptr == ptr_.template Get<0>()) {
             return;
         }
-        auto temp = ptr_.GetFirst();
-        ptr_ = CompressedPair<T*, Deleter>(ptr, Deleter());
-        delete[] temp;
+        auto temp = std::exchange(ptr_.template Get<0>(), ptr);
+        if (temp != nullptr) {
+            GetDeleter()(temp);
+        }
     }
 
     void Swap(UniquePtr& other) {
-        std::swap(ptr_.GetFirst(), other.ptr_.GetFirst());
-        std::swap(ptr_.GetSecond(), other.ptr_.GetSecond());
+        std::swap(ptr_.template Get<0>(), other.ptr_.template Get<0>());
+        std::swap(ptr_.template Get<1>(), other.ptr_.template Get<1>());
     }
 
     ////////////////////////////////////////////////////////////////////////////////////////////////
     // Observers
 
     T* Get() const {
-        return ptr_.GetFirst();
+        return ptr_.template Get<0>();
     }
 
     const Deleter& GetDeleter() const {
-        return ptr_.GetSecond();
+        return ptr_.template Get<1>();
     }
 
     Deleter& GetDeleter() {
-        return ptr_.GetSecond();
+        return ptr_.template Get<1>();
+    }
+
+    // Length of the array, for deleters that know it (see `AlignedDeleter<T[]>`).
+    size_t Size() const requires requires(const Deleter& deleter) { deleter.Size(); } {
+        return Get() != nullptr ? GetDeleter().Size() : 0;
+    }
+
+    std::span<T> Span() const requires requires(const Deleter& deleter) { deleter.Size(); } {
+        return std::span<T>(Get(), Size());
     }
 
     explicit operator bool() const {
-        return ptr_.GetFirst() != nullptr;
+        return ptr_.template Get<0>() != nullptr;
     }
 
     ////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,144 @@
+#pragma once
+
+#include "sw_fwd.h"  // Forward declaration
+#include "shared.h"
+
+#include <cassert>
+#include <cstddef>  // std::nullptr_t
+#include <type_traits>  // std::true_type
+
+// Non-owning view of an object managed by `SharedPtr`.
+// Passing a `BorrowedPtr` down a call chain costs no reference counting at all; a callee that
+// decides to keep the object calls `Promote()` and pays for exactly one increment.
+// The owner must outlive every borrow. Debug builds hold a weak reference on the control block
+// and assert this on every access and on destruction.
+template <typename T>
+class BorrowedPtr {
+private:
+    ControlBlockBase* block_ = nullptr;
+    T* observed_ = nullptr;
+
+public:
+    template <typename S>
+    friend class BorrowedPtr;
+
+    // Relocating a handle is a plain byte copy (see `IsTriviallyRelocatable`).
+    using TriviallyRelocatable = std::true_type;
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Constructors
+
+    BorrowedPtr() {
+    }
+
+    BorrowedPtr(std::nullptr_t) {
+    }
+
+    BorrowedPtr(const SharedPtr<T>& owner) : block_(owner.block_), observed_(owner.observed_) {
+        DebugAcquire();
+    }
+
+    template <typename S>
+    BorrowedPtr(const SharedPtr<S>& owner) : block_(owner.block_), observed_(owner.observed_) {
+        DebugAcquire();
+    }
+
+    BorrowedPtr(const BorrowedPtr& other) : block_(other.block_), observed_(other.observed_) {
+        DebugAcquire();
+    }
+
+    template <typename S>
+    BorrowedPtr(const BorrowedPtr<S>& other) : block_(other.block_), observed_(other.observed_) {
+        DebugAcquire();
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // `operator=`-s
+
+    BorrowedPtr& operator=(const BorrowedPtr& other) {
+        if (this == &other) {
+            return *this;
+        }
+        DebugRelease();
+        block_ = other.block_;
+        observed_ = other.observed_;
+        DebugAcquire();
+        return *this;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Destructor
+
+    ~BorrowedPtr() {
+        DebugRelease();
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Modifiers
+
+    // Take shared ownership. This is the only operation that touches the reference counter.
+    SharedPtr<T> Promote() const {
+        DebugCheck();
+        SharedPtr<T> result;
+        result.block_ = block_;
+        result.observed_ = observed_;
+        result.IncreaseStrongCounter();
+        return result;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Observers
+
+    T* Get() const {
+        DebugCheck();
+        return observed_;
+    }
+
+    T& operator*() const {
+        return *Get();
+    }
+
+    T* operator->() const {
+        return Get();
+    }
+
+    explicit operator bool() const {
+        return observed_ != nullptr;
+    }
+
+private:
+#ifdef NDEBUG
+    void DebugAcquire() {
+    }
+
+    void DebugRelease() {
+    }
+
+    void DebugCheck() const {
+    }
+#else
+    void DebugAcquire() {
+        if (observed_ != nullptr) {
+            block_->IncreaseWeakCounter();
+        }
+    }
+
+    void DebugRelease() {
+        if (observed_ != nullptr) {
+            DebugCheck();
+            block_->ReleaseWeak();
+            observed_ = nullptr;
+            block_ = nullptr;
+        }
+    }
+
+    void DebugCheck() const {
+        assert((observed_ == nullptr || block_->UseStrongCount() != 0) &&
+               "BorrowedPtr outlived its owner");
+    }
+#endif
+};
+
+// Same view, spelled for call sites that think of it as a reference to a shared object.
+template <typename T>
+using SharedRef = BorrowedPtr<T>;
@@ -0,0 +1,274 @@
+#pragma once
+
+#include "sw_fwd.h"  // Forward declaration
+#include "shared.h"
+#include "weak.h"
+
+#include <cstddef>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace observer_list_detail {
+
+// The raw pointer is kept next to the `WeakPtr` only as an identity for `RemoveObserver()`;
+// it is never dereferenced.
+template <typename T>
+struct Entry {
+    WeakPtr<T> weak;
+    const T* observed = nullptr;
+
+    bool Dead() const {
+        return observed == nullptr;
+    }
+
+    void Kill() {
+        weak.Reset();
+        observed = nullptr;
+    }
+};
+
+// Compaction is amortized: it runs once a quarter of the entries (and at least a batch of them)
+// are known to be dead, so a dispatch never pays for more than it skipped before.
+inline bool WorthCompacting(size_t dead, size_t total) {
+    constexpr size_t kMinBatch = 16;
+    return dead >= kMinBatch && dead * 4 >= total;
+}
+
+}  // namespace observer_list_detail
+
+// List of weakly held observers for single-threaded dispatch.
+//
+// `ForEach()` promotes every live entry with one "increment if not zero" (`WeakPtr::TryLock`) into
+// a reused `SharedPtr`, so the callback may drop the last outside reference safely. Expired entries
+// are only marked during dispatch and removed in batches afterwards.
+//
+// The callback may add and remove observers: observers added during dispatch are first notified by
+// the next `ForEach()`, removed ones are not notified again, even in the current pass.
+template <typename T>
+class ObserverList {
+private:
+    using Entry = observer_list_detail::Entry<T>;
+
+    std::vector<Entry> entries_;
+    size_t dead_ = 0;
+    // Nesting level of `ForEach()`; entries must not move while it is positive.
+    size_t depth_ = 0;
+
+public:
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Modifiers
+
+    void AddObserver(const SharedPtr<T>& observer) {
+        if (observer) {
+            entries_.push_back(Entry{WeakPtr<T>(observer), observer.Get()});
+        }
+    }
+
+    // Returns false if `observer` was not in the list. Expired entries met on the way are killed:
+    // a new observer may live at the address of one that died before it was swept.
+    bool RemoveObserver(const T* observer) {
+        bool found = false;
+        for (auto& entry : entries_) {
+            if (entry.Dead()) {
+                continue;
+            }
+            if (entry.weak.Expired()) {
+                entry.Kill();
+                ++dead_;
+            } else if (entry.observed == observer) {
+                entry.Kill();
+                ++dead_;
+                found = true;
+                break;
+            }
+        }
+        MaybeCompact();
+        return found;
+    }
+
+    void Clear() {
+        if (depth_ == 0) {
+            entries_.clear();
+            dead_ = 0;
+            return;
+        }
+        for (auto& entry : entries_) {
+            if (!entry.Dead()) {
+                entry.Kill();
+                ++dead_;
+            }
+        }
+    }
+
+    // Drop every dead entry now. Does nothing during dispatch.
+    void Compact() {
+        if (depth_ != 0) {
+            return;
+        }
+        std::erase_if(entries_, [](const Entry& entry) {
+            return entry.Dead() || entry.weak.Expired();
+        });
+        dead_ = 0;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Dispatch
+
+    // Calls `callback(T&)` for every live observer, in insertion order.
+    template <typename Callback>
+    void ForEach(Callback&& callback) {
+        ++depth_;
+        SharedPtr<T> locked;
+        // Entries appended by the callback are past `size` and wait for the next pass. Indexing
+        // instead of iterators keeps this valid if the vector reallocates.
+        const size_t size = entries_.size();
+        try {
+            for (size_t i = 0; i < size; ++i) {
+                if (entries_[i].Dead()) {
+                    continue;
+                }
+                if (!entries_[i].weak.TryLock(locked)) {
+                    entries_[i].Kill();
+                    ++dead_;
+                    continue;
+                }
+                callback(*locked);
+            }
+        } catch (...) {
+            --depth_;
+            throw;
+        }
+        --depth_;
+        locked.Reset();
+        MaybeCompact();
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Observers
+
+    // Number of entries, including expired ones that were not noticed yet.
+    size_t Size() const {
+        return entries_.size() - dead_;
+    }
+
+    bool Empty() const {
+        return Size() == 0;
+    }
+
+    bool HasObserver(const T* observer) const {
+        for (const auto& entry : entries_) {
+            if (!entry.Dead() && !entry.weak.Expired() && entry.observed == observer) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    void MaybeCompact() {
+        if (depth_ == 0 && observer_list_detail::WorthCompacting(dead_, entries_.size())) {
+            Compact();
+        }
+    }
+};
+
+// Thread-safe variant. Writers copy the entry vector and publish it as a new immutable snapshot,
+// readers only take a reference to the current snapshot under a short lock and dispatch without
+// it, so dispatch never blocks writers and observers may add or remove observers from a callback.
+//
+// A pass works on the snapshot it started with: an observer removed concurrently (or from an
+// earlier callback) may still get the event being dispatched.
+template <typename T>
+class ConcurrentObserverList {
+private:
+    using Entry = observer_list_detail::Entry<T>;
+    using Snapshot = std::vector<Entry>;
+
+    mutable std::mutex mutex_;
+    SharedPtr<Snapshot> snapshot_ = MakeShared<Snapshot>();
+
+public:
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Modifiers
+
+    void AddObserver(const SharedPtr<T>& observer) {
+        if (!observer) {
+            return;
+        }
+        std::lock_guard guard(mutex_);
+        auto next = CopyLive(*snapshot_, nullptr);
+        next->push_back(Entry{WeakPtr<T>(observer), observer.Get()});
+        snapshot_ = std::move(next);
+    }
+
+    bool RemoveObserver(const T* observer) {
+        std::lock_guard guard(mutex_);
+        // Only a live entry counts: an expired one may share the address of a newer observer.
+        bool found = false;
+        for (const auto& entry : *snapshot_) {
+            found = found || (entry.observed == observer && !entry.weak.Expired());
+        }
+        if (found) {
+            snapshot_ = CopyLive(*snapshot_, observer);
+        }
+        return found;
+    }
+
+    void Clear() {
+        std::lock_guard guard(mutex_);
+        snapshot_ = MakeShared<Snapshot>();
+    }
+
+    // Publish a snapshot without expired entries.
+    void Compact() {
+        std::lock_guard guard(mutex_);
+        snapshot_ = CopyLive(*snapshot_, nullptr);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Dispatch
+
+    template <typename Callback>
+    void ForEach(Callback&& callback) {
+        SharedPtr<Snapshot> snapshot = Current();
+        SharedPtr<T> locked;
+        size_t dead = 0;
+        for (const auto& entry : *snapshot) {
+            if (entry.weak.TryLock(locked)) {
+                callback(*locked);
+            } else {
+                ++dead;
+            }
+        }
+        locked.Reset();
+        if (observer_list_detail::WorthCompacting(dead, snapshot->size())) {
+            Compact();
+        }
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Observers
+
+    // Number of entries in the current snapshot, including expired ones not compacted yet.
+    size_t Size() const {
+        return Current()->size();
+    }
+
+private:
+    SharedPtr<Snapshot> Current() const {
+        std::lock_guard guard(mutex_);
+        return snapshot_;
+    }
+
+    static SharedPtr<Snapshot> CopyLive(const Snapshot& from, const T* skip) {
+        auto next = MakeShared<Snapshot>();
+        next->reserve(from.size() + 1);
+        for (const auto& entry : from) {
+            if (entry.observed != skip && !entry.weak.Expired()) {
+                next->push_back(entry);
+            }
+        }
+        return next;
+    }
+};
@@ -0,0 +1,278 @@
+#pragma once
+
+#include "sw_fwd.h"  // Forward declaration
+#include "shared.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#ifdef __linux__
+#include <sched.h>  // sched_getcpu
+#endif
+
+// Control block for a handful of very hot objects that every core copies all the time.
+//
+// While the object is "live", strong increments and decrements go to a per-CPU shard, so copies on
+// different cores never touch the same cache line. The count is only ever checked for zero after
+// the owner retires the object: retiring closes every shard, folds the shard values into
+// `central_` and from then on all counting goes to `central_`.
+//
+// `central_` starts with a large bias, so a decrement that reaches `central_` while shards are
+// still being folded in can never observe a spurious zero; the bias is removed in the same
+// atomic step that adds the folded shard values.
+template <typename T>
+class ControlBlockSharded : public ControlBlockBase {
+private:
+    struct alignas(64) Shard {
+        std::atomic<int64_t> value{0};
+    };
+
+    static constexpr int64_t kClosed = INT64_MIN;
+    static constexpr int64_t kBias = int64_t{1} << 40;
+
+    Shard* shards_;
+    size_t shard_mask_;
+    std::atomic<bool> retiring_{false};
+    // The owner's reference lives here from the start.
+    std::atomic<int64_t> central_{kBias + 1};
+    // One extra weak reference is held collectively by the strong ones.
+    std::atomic<size_t> weak_{1};
+
+public:
+    template <typename... Args>
+    ControlBlockSharded(Args&&... args) {
+        size_t num_shards = 1;
+        while (num_shards < std::thread::hardware_concurrency() && num_shards < 256) {
+            num_shards *= 2;
+        }
+        shards_ = new Shard[num_shards];
+        shard_mask_ = num_shards - 1;
+        new (&aligned_storage_) T(std::forward<Args>(args)...);
+    }
+
+    void IncreaseStrongCounter() override {
+        Add(1);
+    }
+
+    void DecreaseStrongCounter() override {
+        Add(-1);
+    }
+
+    bool TryIncreaseStrongCounter() override {
+        if (TryAddToShard(1)) {
+            return true;
+        }
+        int64_t count = central_.load(std::memory_order_relaxed);
+        while (count != 0) {
+            if (central_.compare_exchange_weak(count, count + 1, std::memory_order_acq_rel,
+                                               std::memory_order_relaxed)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void IncreaseWeakCounter() override {
+        weak_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void DecreaseWeakCounter() override {
+        weak_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    void Release() override {
+        Add(-1);
+    }
+
+    void ReleaseWeak() override {
+        if (weak_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            delete this;
+        }
+    }
+
+    size_t UseCount() override {
+        return UseStrongCount() + weak_.load(std::memory_order_relaxed) - 1;
+    }
+
+    // Exact once retired, a best-effort snapshot while live.
+    size_t UseStrongCount() override {
+        int64_t count = central_.load(std::memory_order_acquire);
+        if (!retiring_.load(std::memory_order_acquire)) {
+            count -= kBias;
+            for (size_t i = 0; i <= shard_mask_; ++i) {
+                int64_t value = shards_[i].value.load(std::memory_order_relaxed);
+                if (value != kClosed) {
+                    count += value;
+                }
+            }
+        }
+        return count > 0 ? static_cast<size_t>(count) : 0;
+    }
+
+    void Delete() override {
+        GetPtr()->~T();
+    }
+
+    // Switch to central counting and drop the bias. Called exactly once, by the owner, which still
+    // holds its own reference, so this never destroys the object.
+    void Retire() {
+        retiring_.store(true, std::memory_order_seq_cst);
+        int64_t folded = 0;
+        for (size_t i = 0; i <= shard_mask_; ++i) {
+            folded += shards_[i].value.exchange(kClosed, std::memory_order_acq_rel);
+        }
+        central_.fetch_add(folded - kBias, std::memory_order_acq_rel);
+    }
+
+    ~ControlBlockSharded() override {
+        delete[] shards_;
+    }
+
+    T* GetPtr() {
+        return std::launder(reinterpret_cast<T*>(&aligned_storage_));
+    }
+
+private:
+    // Succeeds only while the object is live (so the owner's reference keeps it alive).
+    bool TryAddToShard(int64_t delta) {
+        if (retiring_.load(std::memory_order_acquire)) {
+            return false;
+        }
+        auto& slot = shards_[CurrentShard()].value;
+        int64_t value = slot.load(std::memory_order_relaxed);
+        while (value != kClosed) {
+            if (slot.compare_exchange_weak(value, value + delta, std::memory_order_release,
+                                           std::memory_order_relaxed)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void Add(int64_t delta) {
+        if (TryAddToShard(delta)) {
+            return;
+        }
+        if (central_.fetch_add(delta, std::memory_order_acq_rel) + delta == 0) {
+            Delete();
+            ReleaseWeak();
+        }
+    }
+
+    size_t CurrentShard() const {
+#ifdef __linux__
+        int cpu = sched_getcpu();
+        if (cpu >= 0) {
+            return static_cast<size_t>(cpu) & shard_mask_;
+        }
+#endif
+        thread_local const size_t kThreadShard =
+            std::hash<std::thread::id>()(std::this_thread::get_id());
+        return kThreadShard & shard_mask_;
+    }
+
+private:
+    std::aligned_storage_t<sizeof(T), alignof(T)> aligned_storage_;
+};
+
+// Owner of an object with a sharded reference counter. Hand out copies with `Share()`; they are
+// ordinary `SharedPtr`s. Destroying the owner (or calling `Retire()`) switches the counter back to
+// a single atomic, and the object dies together with its last `SharedPtr`.
+template <typename T>
+class ShardedSharedPtr {
+private:
+    ControlBlockSharded<T>* block_ = nullptr;
+
+public:
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Constructors
+
+    ShardedSharedPtr() {
+    }
+
+    explicit ShardedSharedPtr(ControlBlockSharded<T>* block) : block_(block) {
+    }
+
+    ShardedSharedPtr(const ShardedSharedPtr&) = delete;
+
+    ShardedSharedPtr(ShardedSharedPtr&& other) noexcept
+        : block_(std::exchange(other.block_, nullptr)) {
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // `operator=`-s
+
+    ShardedSharedPtr& operator=(const ShardedSharedPtr&) = delete;
+
+    ShardedSharedPtr& operator=(ShardedSharedPtr&& other) noexcept {
+        if (this == &other) {
+            return *this;
+        }
+        Retire();
+        block_ = std::exchange(other.block_, nullptr);
+        return *this;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Destructor
+
+    ~ShardedSharedPtr() {
+        Retire();
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Modifiers
+
+    // Give up ownership. Outstanding `SharedPtr`s keep the object alive.
+    void Retire() {
+        if (block_ != nullptr) {
+            block_->Retire();
+            block_->Release();
+            block_ = nullptr;
+        }
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Observers
+
+    SharedPtr<T> Share() const {
+        SharedPtr<T> result;
+        if (block_ != nullptr) {
+            result.block_ = block_;
+            result.observed_ = block_->GetPtr();
+            result.IncreaseStrongCounter();
+        }
+        return result;
+    }
+
+    T* Get() const {
+        return block_ != nullptr ? block_->GetPtr() : nullptr;
+    }
+
+    T& operator*() const {
+        return *Get();
+    }
+
+    T* operator->() const {
+        return Get();
+    }
+
+    size_t UseCount() const {
+        return block_ != nullptr ? block_->UseStrongCount() : 0;
+    }
+
+    explicit operator bool() const {
+        return block_ != nullptr;
+    }
+};
+
+template <typename T, typename... Args>
+ShardedSharedPtr<T> MakeShardedShared(Args&&... args) {
+    return ShardedSharedPtr<T>(new ControlBlockSharded<T>(std::forward<Args>(args)...));
+}
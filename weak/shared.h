@@ -2,64 +2,72 @@
 
 #include "sw_fwd.h"  // Forward declaration
 
+#include <atomic>
 #include <cstddef>  // std::nullptr_t
 #include <memory>
+#include <type_traits>  // std::true_type
 
-template <typename T>
-class ControlBlockPtr : public ControlBlockBase {
+// Atomic strong and weak counters shared by both control block layouts.
+// `weak_` holds one extra reference on behalf of all strong ones, so exactly one release frees the
+// block no matter how strong and weak releases race.
+class ControlBlockCounted : public ControlBlockBase {
 private:
-    size_t strong_ = 0;
-    size_t weak_ = 0;
+    std::atomic<size_t> strong_ = 1;
+    std::atomic<size_t> weak_ = 1;
 
 public:
-    ControlBlockPtr(T* ptr) : ptr_(ptr) {
-        ++strong_;
-    }
-
     void IncreaseStrongCounter() override {
-        ++strong_;
+        strong_.fetch_add(1, std::memory_order_relaxed);
     }
     void DecreaseStrongCounter() override {
-        --strong_;
+        strong_.fetch_sub(1, std::memory_order_acq_rel);
+    }
+
+    // Single CAS loop: the count is never resurrected once it has dropped to zero.
+    bool TryIncreaseStrongCounter() override {
+        size_t strong = strong_.load(std::memory_order_relaxed);
+        while (strong != 0) {
+            if (strong_.compare_exchange_weak(strong, strong + 1, std::memory_order_acq_rel,
+                                              std::memory_order_relaxed)) {
+                return true;
+            }
+        }
+        return false;
     }
 
     void IncreaseWeakCounter() override {
-        ++weak_;
+        weak_.fetch_add(1, std::memory_order_relaxed);
     }
     void DecreaseWeakCounter() override {
-        --weak_;
+        weak_.fetch_sub(1, std::memory_order_acq_rel);
     }
 
     void Release() override {
-        if (strong_ != 0) {
-            DecreaseStrongCounter();
-            if (strong_ == 0) {
-                this->Delete();
-                if (weak_ == 0) {
-                    delete this;
-                }
-            }
+        if (strong_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            this->Delete();
+            ReleaseWeak();
         }
     }
 
     void ReleaseWeak() override {
-        if (weak_ != 0) {
-            DecreaseWeakCounter();
-            if (weak_ == 0) {
-                //                this->Delete();
-                if (strong_ == 0) {
-                    delete this;
-                }
-            }
+        if (weak_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            delete this;
         }
     }
 
     size_t UseCount() override {
-        return strong_ + weak_;
+        return UseStrongCount() + weak_.load(std::memory_order_relaxed) - 1;
     }
 
     size_t UseStrongCount() override {
-        return strong_;
+        return strong_.load(std::memory_order_acquire);
+    }
+};
+
+template <typename T>
+class ControlBlockPtr : public ControlBlockCounted {
+public:
+    ControlBlockPtr(T* ptr) : ptr_(ptr) {
     }
 
     void Delete() override {
@@ -74,62 +82,11 @@ private:
 };
 
 template <typename T>
-class ControlBlockObj : public ControlBlockBase {
-private:
-    size_t strong_ = 0;
-    size_t weak_ = 0;
-
+class ControlBlockObj : public ControlBlockCounted {
 public:
     template <typename... Args>
     ControlBlockObj(Args&&... args) {
         new (&aligned_storage_) T(std::forward<Args>(args)...);
-        ++strong_;
-    }
-
-    void IncreaseStrongCounter() override {
-        ++strong_;
-    }
-    void DecreaseStrongCounter() override {
-        --strong_;
-    }
-
-    void IncreaseWeakCounter() override {
-        ++weak_;
-    }
-    void DecreaseWeakCounter() override {
-        --weak_;
-    }
-
-    void Release() override {
-        if (strong_ != 0) {
-            this->DecreaseStrongCounter();
-            if (strong_ == 0) {
-                this->Delete();
-                if (weak_ == 0) {
-                    delete this;
-                }
-            }
-        }
-    }
-
-    void ReleaseWeak() override {
-        if (weak_ != 0) {
-            this->DecreaseWeakCounter();
-            if (weak_ == 0) {
-                //                this->Delete();
-                if (strong_ == 0) {
-                    delete this;
-                }
-            }
-        }
-    }
-
-    size_t UseCount() override {
-        return strong_ + weak_;
-    }
-
-    size_t UseStrongCount() override {
-        return strong_;
     }
 
     void Delete() override {
@@ -170,6 +127,15 @@ public:
     template <typename S>
     friend class WeakPtr;
 
+    template <typename S>
+    friend class BorrowedPtr;
+
+    template <typename S>
+    friend class ShardedSharedPtr;
+
+    // Relocating a handle is a plain byte copy (see `IsTriviallyRelocatable`).
+    using TriviallyRelocatable = std::true_type;
+
     ////////////////////////////////////////////////////////////////////////////////////////////////
     // Constructors
 
@@ -189,7 +155,7 @@ public:
         IncreaseStrongCounter();
     }
 
-    SharedPtr(SharedPtr<T>&& other)
+    SharedPtr(SharedPtr<T>&& other) noexcept
         : block_(std::forward<ControlBlockBase*>(other.block_)),
           observed_(std::forward<T*>(other.observed_)) {
         other.block_ = nullptr;
@@ -205,12 +171,8 @@ public:
     // #11 from https://en.cppreference.com/w/cpp/memory/shared_ptr/shared_ptr
 
     explicit SharedPtr(const WeakPtr<T>& other) {
-        if (other.Expired()) {
+        if (!other.TryLock(*this)) {
             throw BadWeakPtr();
-        } else {
-            block_ = other.block_;
-            observed_ = other.observed_;
-            IncreaseStrongCounter();
         }
     }
 
@@ -229,7 +191,7 @@ public:
         return *this;
     }
 
-    SharedPtr& operator=(SharedPtr<T>&& other) {
+    SharedPtr& operator=(SharedPtr<T>&& other) noexcept {
         if (observed_ == other.observed_) {
             return *this;
         }
@@ -255,7 +217,7 @@ public:
     }
 
     template <typename S>
-    SharedPtr(SharedPtr<S>&& other)
+    SharedPtr(SharedPtr<S>&& other) noexcept
         : block_(std::forward<ControlBlockBase*>(other.block_)),
           observed_(std::forward<T*>(reinterpret_cast<T*>(other.observed_))) {
         other.block_ = nullptr;
@@ -278,7 +240,7 @@ public:
     }
 
     template <typename S>
-    SharedPtr& operator=(SharedPtr<S>&& other) {
+    SharedPtr& operator=(SharedPtr<S>&& other) noexcept {
         if (observed_ == other.observed_) {
             return *this;
         }
@@ -331,7 +293,7 @@ public:
         }
     }
 
-    void Swap(SharedPtr& other) {
+    void Swap(SharedPtr& other) noexcept {
         std::swap(block_, other.block_);
         std::swap(observed_, other.observed_);
     }
@@ -0,0 +1,243 @@
+#pragma once
+
+#include "sw_fwd.h"  // Forward declaration
+#include "shared.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Generational handle into a `SlotMap`: a slot index and the generation of the slot at the time
+// the handle was issued. With a 32-bit word the split is 20 bits of index (about a million live
+// objects) and 12 bits of generation; with a 64-bit word it is 32/32.
+// The all-zero handle is never issued and stands for "null".
+template <typename Word>
+class SlotHandle {
+    static_assert(std::is_same_v<Word, uint32_t> || std::is_same_v<Word, uint64_t>);
+
+public:
+    static constexpr unsigned kIndexBits = sizeof(Word) == 4 ? 20 : 32;
+    static constexpr unsigned kGenerationBits = sizeof(Word) * 8 - kIndexBits;
+    static constexpr Word kMaxIndex = (Word{1} << kIndexBits) - 1;
+    static constexpr Word kMaxGeneration = (Word{1} << kGenerationBits) - 1;
+
+    SlotHandle() = default;
+
+    SlotHandle(Word index, Word generation) : bits_(generation << kIndexBits | index) {
+    }
+
+    Word Index() const {
+        return bits_ & kMaxIndex;
+    }
+
+    Word Generation() const {
+        return bits_ >> kIndexBits;
+    }
+
+    Word Bits() const {
+        return bits_;
+    }
+
+    explicit operator bool() const {
+        return bits_ != 0;
+    }
+
+    bool operator==(const SlotHandle& other) const {
+        return bits_ == other.bits_;
+    }
+
+    bool operator!=(const SlotHandle& other) const {
+        return bits_ != other.bits_;
+    }
+
+private:
+    Word bits_ = 0;
+};
+
+// Owning container of `T`s addressed by generational handles: a compact alternative to keeping a
+// `WeakPtr` per observer. Objects are stored contiguously (erasing moves the last one into the
+// hole), and resolving a handle is a bounds check plus a generation compare - no control block,
+// no counter traffic. A slot whose generation would wrap is retired instead of being reused, so a
+// stale handle can never resolve to a newer object.
+template <typename T, typename Word = uint32_t>
+class SlotMap {
+public:
+    using Handle = SlotHandle<Word>;
+
+private:
+    struct Slot {
+        // Position in `values_` while occupied, next free slot otherwise.
+        Word target;
+        Word generation;
+    };
+
+    static constexpr Word kNoSlot = ~Word{0};
+
+    std::vector<T> values_;
+    std::vector<Word> value_slots_;
+    std::vector<Slot> slots_;
+    Word free_head_ = kNoSlot;
+
+public:
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Modifiers
+
+    template <typename... Args>
+    Handle Emplace(Args&&... args) {
+        Word index = AcquireSlot();
+        try {
+            values_.emplace_back(std::forward<Args>(args)...);
+            try {
+                value_slots_.push_back(index);
+            } catch (...) {
+                values_.pop_back();
+                throw;
+            }
+        } catch (...) {
+            // No handle was issued, so the slot goes back with its generation unchanged.
+            slots_[index].target = free_head_;
+            free_head_ = index;
+            throw;
+        }
+        slots_[index].target = static_cast<Word>(values_.size() - 1);
+        return Handle(index, slots_[index].generation);
+    }
+
+    Handle Insert(T value) {
+        return Emplace(std::move(value));
+    }
+
+    // Take the object over from its only owner. The value is moved into the map and the original
+    // allocation is freed, so every `WeakPtr` to it expires. A null `ptr` gives a null handle; a
+    // shared one is rejected with `std::invalid_argument`.
+    Handle Adopt(SharedPtr<T>&& ptr) {
+        if (!ptr) {
+            return Handle();
+        }
+        if (ptr.UseCount() != 1) {
+            throw std::invalid_argument("SlotMap can only adopt a uniquely owned object");
+        }
+        Handle handle = Emplace(std::move(*ptr));
+        ptr.Reset();
+        return handle;
+    }
+
+    // Move the object out into a new `SharedPtr`; the handle goes stale. Like `Adopt`, this moves
+    // the value rather than the allocation.
+    SharedPtr<T> Extract(Handle handle) {
+        T* value = Get(handle);
+        if (value == nullptr) {
+            return SharedPtr<T>();
+        }
+        auto result = MakeShared<T>(std::move(*value));
+        Erase(handle);
+        return result;
+    }
+
+    bool Erase(Handle handle) {
+        if (Get(handle) == nullptr) {
+            return false;
+        }
+        Word index = handle.Index();
+        Word position = slots_[index].target;
+        Word last = static_cast<Word>(values_.size() - 1);
+        if (position != last) {
+            values_[position] = std::move(values_[last]);
+            value_slots_[position] = value_slots_[last];
+            slots_[value_slots_[position]].target = position;
+        }
+        values_.pop_back();
+        value_slots_.pop_back();
+        ReleaseSlot(index);
+        return true;
+    }
+
+    void Clear() {
+        for (Word position = 0; position < values_.size(); ++position) {
+            ReleaseSlot(value_slots_[position]);
+        }
+        values_.clear();
+        value_slots_.clear();
+    }
+
+    void Reserve(size_t capacity) {
+        values_.reserve(capacity);
+        value_slots_.reserve(capacity);
+        slots_.reserve(capacity);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Observers
+
+    T* Get(Handle handle) {
+        Word index = handle.Index();
+        // Generation zero marks retired slots and is never issued.
+        if (index >= slots_.size() || slots_[index].generation != handle.Generation() ||
+            handle.Generation() == 0) {
+            return nullptr;
+        }
+        return &values_[slots_[index].target];
+    }
+
+    const T* Get(Handle handle) const {
+        return const_cast<SlotMap*>(this)->Get(handle);
+    }
+
+    bool Contains(Handle handle) const {
+        return Get(handle) != nullptr;
+    }
+
+    size_t Size() const {
+        return values_.size();
+    }
+
+    bool Empty() const {
+        return values_.empty();
+    }
+
+    // Iteration goes over the dense array, in no particular order.
+    T* begin() {
+        return values_.data();
+    }
+
+    T* end() {
+        return values_.data() + values_.size();
+    }
+
+    const T* begin() const {
+        return values_.data();
+    }
+
+    const T* end() const {
+        return values_.data() + values_.size();
+    }
+
+private:
+    Word AcquireSlot() {
+        if (free_head_ != kNoSlot) {
+            Word index = free_head_;
+            free_head_ = slots_[index].target;
+            return index;
+        }
+        if (slots_.size() > Handle::kMaxIndex) {
+            throw std::length_error("SlotMap: out of slot indices");
+        }
+        slots_.push_back(Slot{0, 1});
+        return static_cast<Word>(slots_.size() - 1);
+    }
+
+    void ReleaseSlot(Word index) {
+        Slot& slot = slots_[index];
+        if (slot.generation == Handle::kMaxGeneration) {
+            // Retire the slot: its generation would wrap back to one already handed out.
+            slot.generation = 0;
+            return;
+        }
+        ++slot.generation;
+        slot.target = free_head_;
+        free_head_ = index;
+    }
+};
@@ -9,6 +9,11 @@ public:
     virtual void IncreaseStrongCounter() {
     }
 
+    // Increment only if the object is still alive, as one atomic step.
+    virtual bool TryIncreaseStrongCounter() {
+        return false;
+    }
+
     virtual void DecreaseStrongCounter() {
     }
 
@@ -44,3 +49,9 @@ class SharedPtr;
 
 template <typename T>
 class WeakPtr;
+
+template <typename T>
+class BorrowedPtr;
+
+template <typename T>
+class ShardedSharedPtr;
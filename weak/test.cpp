@@ -2,9 +2,14 @@
 #include "weak.h"
 
 #include <common/my_int.h>
+#include <common/relocatable.h>
 
 #include <catch.hpp>
 
+#include <atomic>
+#include <thread>
+#include <vector>
+
 #include "allocations_checker.h"
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -147,6 +152,63 @@ TEST_CASE("Shared from invalid Weak") {
     REQUIRE_THROWS_AS(SharedPtr<int>(w_ptr), BadWeakPtr);
 }
 
+TEST_CASE("TryLock") {
+    SECTION("Alive") {
+        auto sp = MakeShared<std::string>("aba");
+        WeakPtr<std::string> wp(sp);
+        SharedPtr<std::string> locked(new std::string("other"));
+        REQUIRE(wp.TryLock(locked));
+        REQUIRE(locked.Get() == sp.Get());
+        REQUIRE(sp.UseCount() == 2);
+    }
+
+    SECTION("Expired") {
+        WeakPtr<std::string> wp;
+        SharedPtr<std::string> locked;
+        REQUIRE(!wp.TryLock(locked));
+        {
+            auto sp = MakeShared<std::string>("aba");
+            wp = sp;
+        }
+        locked = MakeShared<std::string>("kept");
+        REQUIRE(!wp.TryLock(locked));
+        REQUIRE(*locked == "kept");
+    }
+
+    SECTION("Racing with the last release") {
+        constexpr int kThreads = 4;
+        constexpr int kRounds = 1000;
+
+        std::atomic<int> corrupted = 0;
+        for (int round = 0; round < kRounds; ++round) {
+            auto sp = MakeShared<std::string>("aba");
+            std::vector<WeakPtr<std::string>> weaks(kThreads, WeakPtr<std::string>(sp));
+            std::vector<std::thread> threads;
+            for (int i = 0; i < kThreads; ++i) {
+                threads.emplace_back([&weak = weaks[i], &corrupted] {
+                    SharedPtr<std::string> locked;
+                    while (weak.TryLock(locked)) {
+                        if (*locked != "aba") {
+                            ++corrupted;
+                        }
+                        locked.Reset();
+                    }
+                });
+            }
+            sp.Reset();
+            for (auto& thread : threads) {
+                thread.join();
+            }
+            for (auto& weak : weaks) {
+                SharedPtr<std::string> tmp;
+                REQUIRE(!weak.TryLock(tmp));
+                REQUIRE(weak.Expired());
+            }
+        }
+        REQUIRE(corrupted == 0);
+    }
+}
+
 TEST_CASE("Constness") {
     SharedPtr<int> sp(new int(42));
     WeakPtr<const int> wp(sp);
@@ -175,3 +237,44 @@ TEST_CASE("Lifetimes") {
         delete wp;
     }
 }
+
+TEST_CASE("Relocation") {
+    SECTION("Noexcept") {
+        static_assert(std::is_nothrow_move_constructible_v<SharedPtr<int>>);
+        static_assert(std::is_nothrow_move_assignable_v<SharedPtr<int>>);
+        static_assert(std::is_nothrow_move_constructible_v<WeakPtr<int>>);
+        static_assert(std::is_nothrow_move_assignable_v<WeakPtr<int>>);
+        static_assert(kIsTriviallyRelocatable<SharedPtr<int>>);
+        static_assert(kIsTriviallyRelocatable<WeakPtr<int>>);
+    }
+
+    SECTION("Growth keeps counters") {
+        auto sp = MakeShared<std::string>("aba");
+        RelocatingVector<SharedPtr<std::string>> shared;
+        RelocatingVector<WeakPtr<std::string>> weak;
+        for (int i = 0; i < 1000; ++i) {
+            shared.PushBack(sp);
+            weak.EmplaceBack(sp);
+        }
+        REQUIRE(sp.UseCount() == 1001);
+        for (auto&& ptr : shared) {
+            REQUIRE(ptr.Get() == sp.Get());
+        }
+
+        shared.Clear();
+        REQUIRE(sp.UseCount() == 1);
+        sp.Reset();
+        REQUIRE(weak[999].Expired());
+    }
+
+    SECTION("Self-referencing push") {
+        RelocatingVector<SharedPtr<int>> shared;
+        shared.PushBack(MakeShared<int>(42));
+        for (int i = 0; i < 100; ++i) {
+            shared.PushBack(shared[0]);
+        }
+        REQUIRE(shared.Size() == 101);
+        REQUIRE(*shared[100] == 42);
+        REQUIRE(shared[0].UseCount() == 101);
+    }
+}
@@ -0,0 +1,96 @@
+#include "shared.h"
+#include "borrowed.h"
+
+#include <catch.hpp>
+
+#include "allocations_checker.h"
+
+#include <string>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+size_t Depth(BorrowedPtr<std::string> ptr, int depth) {
+    if (depth == 0) {
+        return ptr->size();
+    }
+    return Depth(ptr, depth - 1);
+}
+
+struct Keeper {
+    void MaybeKeep(BorrowedPtr<std::string> ptr) {
+        if (ptr && ptr->size() > 3) {
+            kept = ptr.Promote();
+        }
+    }
+
+    SharedPtr<std::string> kept;
+};
+
+}  // namespace
+
+TEST_CASE("Borrowed basics") {
+    SECTION("Empty") {
+        BorrowedPtr<int> a;
+        BorrowedPtr<int> b(nullptr);
+        BorrowedPtr<int> c(SharedPtr<int>{});
+        REQUIRE(a.Get() == nullptr);
+        REQUIRE(!b);
+        REQUIRE(c.Promote().Get() == nullptr);
+    }
+
+    SECTION("No counting") {
+        auto sp = MakeShared<std::string>("abacaba");
+        REQUIRE(Depth(sp, 10) == 7);
+        REQUIRE(sp.UseCount() == 1);
+        EXPECT_ZERO_ALLOCATIONS(Depth(sp, 10));
+    }
+
+    SECTION("Dereference") {
+        auto sp = MakeShared<std::string>("aba");
+        SharedRef<std::string> ref(sp);
+        REQUIRE(*ref == "aba");
+        REQUIRE(ref.Get() == sp.Get());
+        ref->push_back('c');
+        REQUIRE(*sp == "abac");
+    }
+}
+
+TEST_CASE("Borrowed promotion") {
+    Keeper keeper;
+    {
+        auto small = MakeShared<std::string>("aba");
+        keeper.MaybeKeep(small);
+        REQUIRE(small.UseCount() == 1);
+        REQUIRE(!keeper.kept);
+    }
+    {
+        SharedPtr<std::string> large(new std::string("abacaba"));
+        keeper.MaybeKeep(large);
+        REQUIRE(large.UseCount() == 2);
+    }
+    REQUIRE(keeper.kept.UseCount() == 1);
+    REQUIRE(*keeper.kept == "abacaba");
+}
+
+TEST_CASE("Borrowed conversions") {
+    struct Base {
+        virtual ~Base() = default;
+        int value = 1;
+    };
+    struct Derived : Base {
+        int extra = 2;
+    };
+
+    auto sp = MakeShared<Derived>();
+    BorrowedPtr<Derived> derived(sp);
+    BorrowedPtr<Base> base(derived);
+    BorrowedPtr<Base> copy;
+    copy = base;
+    REQUIRE(copy->value == 1);
+
+    SharedPtr<Base> kept = copy.Promote();
+    REQUIRE(sp.UseCount() == 2);
+    REQUIRE(kept.Get() == sp.Get());
+}
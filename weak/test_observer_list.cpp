@@ -0,0 +1,219 @@
+#include "shared.h"
+#include "weak.h"
+#include "observer_list.h"
+
+#include <catch.hpp>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+struct Listener {
+    void OnEvent() {
+        ++events;
+    }
+
+    int events = 0;
+};
+
+}  // namespace
+
+TEST_CASE("Observer list basics") {
+    ObserverList<Listener> list;
+    auto a = MakeShared<Listener>();
+    auto b = MakeShared<Listener>();
+    list.AddObserver(a);
+    list.AddObserver(b);
+    list.AddObserver(SharedPtr<Listener>());
+    REQUIRE(list.Size() == 2);
+
+    list.ForEach([](Listener& listener) { listener.OnEvent(); });
+    REQUIRE(a->events == 1);
+    REQUIRE(b->events == 1);
+    REQUIRE(a.UseCount() == 1);
+
+    REQUIRE(list.RemoveObserver(a.Get()));
+    REQUIRE(!list.RemoveObserver(a.Get()));
+    REQUIRE(!list.HasObserver(a.Get()));
+    REQUIRE(list.HasObserver(b.Get()));
+
+    b.Reset();
+    REQUIRE(!list.HasObserver(b.Get()));
+    int calls = 0;
+    list.ForEach([&calls](Listener&) { ++calls; });
+    REQUIRE(calls == 0);
+    REQUIRE(list.Empty());
+}
+
+TEST_CASE("Observer list compaction") {
+    ObserverList<Listener> list;
+    std::vector<SharedPtr<Listener>> owners;
+    for (int i = 0; i < 100; ++i) {
+        owners.push_back(MakeShared<Listener>());
+        list.AddObserver(owners.back());
+    }
+    // Kill every other observer: their control blocks are held only by the list now.
+    for (int i = 0; i < 100; i += 2) {
+        owners[i].Reset();
+    }
+    REQUIRE(list.Size() == 100);
+
+    int calls = 0;
+    list.ForEach([&calls](Listener&) { ++calls; });
+    REQUIRE(calls == 50);
+    REQUIRE(list.Size() == 50);
+
+    list.ForEach([](Listener& listener) { listener.OnEvent(); });
+    for (int i = 1; i < 100; i += 2) {
+        REQUIRE(owners[i]->events == 1);
+    }
+}
+
+TEST_CASE("Observer list address reuse") {
+    // Both observers live in `slot`; each aliases its own owner, so the first one expires while
+    // its entry is still in the list and the second one is subscribed at the same address.
+    Listener slot;
+    auto first = SharedPtr<Listener>(MakeShared<int>(), &slot);
+    auto second = SharedPtr<Listener>(MakeShared<int>(), &slot);
+
+    SECTION("Single-threaded") {
+        ObserverList<Listener> list;
+        list.AddObserver(first);
+        first.Reset();
+        list.AddObserver(second);
+        REQUIRE(list.HasObserver(&slot));
+
+        REQUIRE(list.RemoveObserver(&slot));
+        REQUIRE(!list.HasObserver(&slot));
+        REQUIRE(!list.RemoveObserver(&slot));
+        int calls = 0;
+        list.ForEach([&calls](Listener&) { ++calls; });
+        REQUIRE(calls == 0);
+        REQUIRE(list.Empty());
+    }
+
+    SECTION("Concurrent") {
+        ConcurrentObserverList<Listener> list;
+        list.AddObserver(first);
+        first.Reset();
+        REQUIRE(!list.RemoveObserver(&slot));
+
+        list.AddObserver(second);
+        REQUIRE(list.RemoveObserver(&slot));
+        REQUIRE(!list.RemoveObserver(&slot));
+        int calls = 0;
+        list.ForEach([&calls](Listener&) { ++calls; });
+        REQUIRE(calls == 0);
+        REQUIRE(list.Size() == 0);
+    }
+}
+
+TEST_CASE("Observer list mutation during dispatch") {
+    ObserverList<Listener> list;
+    auto a = MakeShared<Listener>();
+    auto b = MakeShared<Listener>();
+    auto c = MakeShared<Listener>();
+    list.AddObserver(a);
+    list.AddObserver(b);
+
+    SECTION("Remove later observer") {
+        list.ForEach([&](Listener& listener) {
+            listener.OnEvent();
+            list.RemoveObserver(b.Get());
+        });
+        REQUIRE(a->events == 1);
+        REQUIRE(b->events == 0);
+        REQUIRE(list.Size() == 1);
+    }
+
+    SECTION("Add during dispatch") {
+        list.ForEach([&](Listener& listener) {
+            listener.OnEvent();
+            list.AddObserver(c);
+        });
+        REQUIRE(c->events == 0);
+        list.ForEach([](Listener& listener) { listener.OnEvent(); });
+        REQUIRE(c->events == 2);
+        REQUIRE(a->events == 2);
+    }
+
+    SECTION("Drop the last owner from a callback") {
+        list.ForEach([&](Listener& listener) {
+            a.Reset();
+            b.Reset();
+            listener.OnEvent();
+        });
+        // `a` died when the pass released it; the next pass notices.
+        REQUIRE(list.Size() == 1);
+        int calls = 0;
+        list.ForEach([&calls](Listener&) { ++calls; });
+        REQUIRE(calls == 0);
+        REQUIRE(list.Empty());
+    }
+
+    SECTION("Nested dispatch") {
+        int inner = 0;
+        list.ForEach([&](Listener&) {
+            list.ForEach([&](Listener&) { ++inner; });
+            list.Clear();
+        });
+        REQUIRE(inner == 2);
+        REQUIRE(list.Empty());
+    }
+}
+
+TEST_CASE("Concurrent observer list") {
+    ConcurrentObserverList<Listener> list;
+    auto a = MakeShared<Listener>();
+    auto b = MakeShared<Listener>();
+    list.AddObserver(a);
+    list.AddObserver(b);
+
+    SECTION("Snapshot semantics") {
+        list.ForEach([&](Listener& listener) {
+            listener.OnEvent();
+            list.RemoveObserver(b.Get());
+        });
+        REQUIRE(b->events == 1);
+        list.ForEach([](Listener& listener) { listener.OnEvent(); });
+        REQUIRE(a->events == 2);
+        REQUIRE(b->events == 1);
+        REQUIRE(list.Size() == 1);
+    }
+
+    SECTION("Expired entries are dropped") {
+        b.Reset();
+        list.Compact();
+        REQUIRE(list.Size() == 1);
+    }
+
+    SECTION("Threads") {
+        constexpr int kThreads = 4;
+        constexpr int kRounds = 1000;
+
+        std::atomic<int> calls = 0;
+        std::vector<std::thread> threads;
+        for (int i = 0; i < kThreads; ++i) {
+            threads.emplace_back([&list, &calls, i]() {
+                for (int j = 0; j < kRounds; ++j) {
+                    if (i == 0) {
+                        auto local = MakeShared<Listener>();
+                        list.AddObserver(local);
+                        list.RemoveObserver(local.Get());
+                    } else {
+                        list.ForEach([&calls](Listener&) { ++calls; });
+                    }
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        REQUIRE(calls >= 2 * (kThreads - 1) * kRounds);
+        REQUIRE(list.Size() == 2);
+    }
+}
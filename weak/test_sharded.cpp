@@ -0,0 +1,95 @@
+#include "shared.h"
+#include "weak.h"
+#include "sharded.h"
+
+#include <common/my_int.h>
+
+#include <catch.hpp>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("Sharded basics") {
+    SECTION("Empty") {
+        ShardedSharedPtr<int> owner;
+        REQUIRE(!owner);
+        REQUIRE(owner.Share().Get() == nullptr);
+        REQUIRE(owner.UseCount() == 0);
+    }
+
+    SECTION("Share") {
+        auto owner = MakeShardedShared<std::string>("config");
+        REQUIRE(*owner == "config");
+        REQUIRE(owner.UseCount() == 1);
+        {
+            auto a = owner.Share();
+            auto b = a;
+            REQUIRE(*b == "config");
+            REQUIRE(owner.UseCount() == 3);
+        }
+        REQUIRE(owner.UseCount() == 1);
+    }
+
+    SECTION("Outlives owner") {
+        SharedPtr<MyInt> kept;
+        {
+            auto owner = MakeShardedShared<MyInt>(42);
+            kept = owner.Share();
+        }
+        REQUIRE(MyInt::AliveCount() == 1);
+        REQUIRE(*kept == 42);
+        REQUIRE(kept.UseCount() == 1);
+        kept.Reset();
+        REQUIRE(MyInt::AliveCount() == 0);
+    }
+
+    SECTION("Weak") {
+        WeakPtr<MyInt> weak;
+        {
+            auto owner = MakeShardedShared<MyInt>(42);
+            weak = owner.Share();
+            REQUIRE(!weak.Expired());
+            auto locked = weak.Lock();
+            REQUIRE(*locked == 42);
+        }
+        REQUIRE(weak.Expired());
+        REQUIRE(MyInt::AliveCount() == 0);
+    }
+}
+
+TEST_CASE("Sharded concurrent copies") {
+    constexpr int kThreads = 8;
+    constexpr int kIterations = 100'000;
+
+    SECTION("Retire while copying") {
+        auto owner = MakeShardedShared<MyInt>(7);
+        std::vector<SharedPtr<MyInt>> roots;
+        for (int i = 0; i < kThreads; ++i) {
+            roots.push_back(owner.Share());
+        }
+
+        std::atomic<int> empty_copies = 0;
+        std::vector<std::thread> threads;
+        for (int i = 0; i < kThreads; ++i) {
+            threads.emplace_back([root = std::move(roots[i]), &empty_copies]() mutable {
+                for (int j = 0; j < kIterations; ++j) {
+                    SharedPtr<MyInt> copy = root;
+                    if (!copy) {
+                        ++empty_copies;
+                    }
+                }
+                root.Reset();
+            });
+        }
+        owner.Retire();
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        REQUIRE(empty_copies == 0);
+    }
+    REQUIRE(MyInt::AliveCount() == 0);
+}
@@ -0,0 +1,170 @@
+#include "shared.h"
+#include "slot_map.h"
+#include "weak.h"
+
+#include <catch.hpp>
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+struct Movable {
+    Movable(int value) : value(value) {
+        ++alive;
+    }
+
+    Movable(Movable&& other) : value(other.value) {
+        ++alive;
+    }
+
+    Movable& operator=(Movable&& other) = default;
+
+    ~Movable() {
+        --alive;
+    }
+
+    int value;
+
+    static inline int alive = 0;
+};
+
+}  // namespace
+
+TEST_CASE("Slot map basics") {
+    SECTION("Sizeof") {
+        static_assert(sizeof(SlotMap<int>::Handle) == 4);
+        static_assert(sizeof(SlotMap<int, uint64_t>::Handle) == 8);
+    }
+
+    SECTION("Insert and resolve") {
+        SlotMap<std::string> map;
+        auto a = map.Insert("a");
+        auto b = map.Emplace(3, 'b');
+        REQUIRE(map.Size() == 2);
+        REQUIRE(*map.Get(a) == "a");
+        REQUIRE(*map.Get(b) == "bbb");
+        REQUIRE(map.Get(SlotMap<std::string>::Handle()) == nullptr);
+    }
+
+    SECTION("Stale handles") {
+        SlotMap<std::string> map;
+        auto a = map.Insert("a");
+        auto b = map.Insert("b");
+        REQUIRE(map.Erase(a));
+        REQUIRE(!map.Erase(a));
+        REQUIRE(!map.Contains(a));
+        REQUIRE(*map.Get(b) == "b");
+
+        auto c = map.Insert("c");
+        REQUIRE(c.Index() == a.Index());
+        REQUIRE(c != a);
+        REQUIRE(map.Get(a) == nullptr);
+        REQUIRE(*map.Get(c) == "c");
+    }
+
+    SECTION("Dense iteration") {
+        SlotMap<int> map;
+        std::vector<SlotMap<int>::Handle> handles;
+        for (int i = 0; i < 100; ++i) {
+            handles.push_back(map.Insert(i));
+        }
+        for (int i = 0; i < 100; i += 2) {
+            map.Erase(handles[i]);
+        }
+        int sum = 0;
+        for (int value : map) {
+            sum += value;
+        }
+        REQUIRE(map.Size() == 50);
+        REQUIRE(sum == 2500);
+        for (int i = 1; i < 100; i += 2) {
+            REQUIRE(*map.Get(handles[i]) == i);
+        }
+    }
+
+    SECTION("Lifetimes") {
+        {
+            SlotMap<Movable> map;
+            auto a = map.Emplace(1);
+            auto b = map.Emplace(2);
+            map.Erase(a);
+            REQUIRE(Movable::alive == 1);
+            REQUIRE(map.Get(b)->value == 2);
+            map.Clear();
+            REQUIRE(Movable::alive == 0);
+            REQUIRE(!map.Contains(b));
+            map.Emplace(3);
+        }
+        REQUIRE(Movable::alive == 0);
+    }
+}
+
+TEST_CASE("Slot map generations") {
+    SlotMap<int> map;
+    auto first = map.Insert(0);
+    auto last = first;
+    for (size_t i = 0; i < SlotMap<int>::Handle::kMaxGeneration; ++i) {
+        map.Erase(last);
+        last = map.Insert(0);
+    }
+    // The slot of `first` is exhausted and must not come back.
+    REQUIRE(last.Index() != first.Index());
+    REQUIRE(!map.Contains(first));
+    REQUIRE(map.Contains(last));
+}
+
+TEST_CASE("Slot map and SharedPtr") {
+    SlotMap<std::string> map;
+    auto handle = map.Adopt(MakeShared<std::string>("adopted"));
+    REQUIRE(*map.Get(handle) == "adopted");
+
+    SharedPtr<std::string> owner = map.Extract(handle);
+    REQUIRE(*owner == "adopted");
+    REQUIRE(owner.UseCount() == 1);
+    REQUIRE(!map.Contains(handle));
+    REQUIRE(map.Extract(handle).Get() == nullptr);
+
+    // The value moves, not the allocation.
+    auto adopted = MakeShared<std::string>("moved");
+    WeakPtr<std::string> weak(adopted);
+    handle = map.Adopt(std::move(adopted));
+    REQUIRE(weak.Expired());
+    REQUIRE(*map.Get(handle) == "moved");
+
+    REQUIRE(!map.Adopt(SharedPtr<std::string>()));
+    auto shared = MakeShared<std::string>("shared");
+    SharedPtr<std::string> copy = shared;
+    REQUIRE_THROWS_AS(map.Adopt(std::move(shared)), std::invalid_argument);
+    REQUIRE(map.Size() == 1);
+}
+
+namespace {
+
+struct Picky {
+    explicit Picky(int value) : value(value) {
+        if (value < 0) {
+            throw std::invalid_argument("negative");
+        }
+    }
+
+    int value;
+};
+
+}  // namespace
+
+TEST_CASE("Slot map with throwing constructors") {
+    SlotMap<Picky> map;
+    auto a = map.Emplace(1);
+    REQUIRE_THROWS_AS(map.Emplace(-1), std::invalid_argument);
+    REQUIRE(map.Size() == 1);
+
+    // The slot taken by the failed insertion is handed out again.
+    auto b = map.Emplace(2);
+    REQUIRE(b.Index() == a.Index() + 1);
+    REQUIRE(map.Get(a)->value == 1);
+    REQUIRE(map.Get(b)->value == 2);
+}
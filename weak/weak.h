@@ -2,6 +2,8 @@
 
 #include "sw_fwd.h"  // Forward declaration
 
+#include <type_traits>  // std::true_type
+
 // https://en.cppreference.com/w/cpp/memory/weak_ptr
 
 template <typename T>
@@ -17,6 +19,9 @@ public:
     template <typename S>
     friend class WeakPtr;
 
+    // Relocating a handle is a plain byte copy (see `IsTriviallyRelocatable`).
+    using TriviallyRelocatable = std::true_type;
+
     ////////////////////////////////////////////////////////////////////////////////////////////////
     // Constructors
 
@@ -26,7 +31,7 @@ public:
     WeakPtr(const WeakPtr<T>& other) : block_(other.block_), observed_(other.observed_) {
         IncreaseWeakCounter();
     }
-    WeakPtr(WeakPtr<T>&& other)
+    WeakPtr(WeakPtr<T>&& other) noexcept
         : block_(std::forward<ControlBlockBase*>(other.block_)),
           observed_(std::forward<T*>(other.observed_)) {
         other.block_ = nullptr;
@@ -54,7 +59,7 @@ public:
         return *this;
     }
 
-    WeakPtr& operator=(WeakPtr<T>&& other) {
+    WeakPtr& operator=(WeakPtr<T>&& other) noexcept {
         if (observed_ == other.observed_) {
             return *this;
         }
@@ -76,7 +81,7 @@ public:
     }
 
     template <typename S>
-    WeakPtr(WeakPtr<S>&& other)
+    WeakPtr(WeakPtr<S>&& other) noexcept
         : block_(std::forward<ControlBlockBase*>(other.block_)),
           observed_(std::forward<T*>(reinterpret_cast<T*>(other.observed_))) {
         other.block_ = nullptr;
@@ -108,7 +113,7 @@ public:
     }
 
     template <typename S>
-    WeakPtr& operator=(WeakPtr<S>&& other) {
+    WeakPtr& operator=(WeakPtr<S>&& other) noexcept {
         if (observed_ == other.observed_) {
             return *this;
         }
@@ -142,7 +147,7 @@ public:
         ReleaseWeak();
     }
 
-    void Swap(WeakPtr& other) {
+    void Swap(WeakPtr& other) noexcept {
         std::swap(block_, other.block_);
         std::swap(observed_, other.observed_);
     }
@@ -178,9 +183,20 @@ public:
     }
 
     SharedPtr<T> Lock() const {
-        if (Expired()) {
-            return SharedPtr<T>();
+        SharedPtr<T> result;
+        TryLock(result);
+        return result;
+    }
+
+    // Promote into `result` with a single "increment if not zero" on the control block.
+    // Leaves `result` untouched and returns false if the object is already gone.
+    bool TryLock(SharedPtr<T>& result) const {
+        if (observed_ == nullptr || !block_->TryIncreaseStrongCounter()) {
+            return false;
         }
-        return SharedPtr<T>(*this);
+        result.Release();
+        result.block_ = block_;
+        result.observed_ = observed_;
+        return true;
     }
 };